@@ -1,12 +1,16 @@
 #include <IR.h>
 #include <Firrtlator.h>
 
+#include <cstdlib>
+#include <stdexcept>
 #include <iostream>
 #include <unistd.h>
 #include <string>
 #include <vector>
 
 void help(void);
+void printHierarchy(Firrtlator::Firrtlator &firrtlator);
+void failParsing(const std::vector<std::string> &input_files);
 
 int main(int argc, char* argv[]) {
 	int c;
@@ -14,15 +18,39 @@ int main(int argc, char* argv[]) {
 	std::vector<std::string> input_files;
 	std::vector<std::string> passes;
 	std::string output_file = "out.fir";
-
-	while ((c = getopt (argc, argv, "hi:p:")) != -1) {
+	std::string frontend;
+	int threads = 1;
+	std::string cache;
+	unsigned long long cache_limit = 0;
+	bool cache_stats = false;
+	bool hierarchy = false;
+
+	while ((c = getopt (argc, argv, "hi:f:j:p:c:C:sH")) != -1) {
 		switch(c) {
 		case 'i':
 			input_files.push_back(optarg);
 			break;
+		case 'f':
+			frontend = optarg;
+			break;
+		case 'j':
+			threads = atoi(optarg);
+			break;
 		case 'p':
 			passes.push_back(optarg);
 			break;
+		case 'c':
+			cache = optarg;
+			break;
+		case 'C':
+			cache_limit = strtoull(optarg, nullptr, 10) << 20;
+			break;
+		case 's':
+			cache_stats = true;
+			break;
+		case 'H':
+			hierarchy = true;
+			break;
 		case 'h':
 			help();
 			exit(0);
@@ -38,31 +66,59 @@ int main(int argc, char* argv[]) {
 		std::cerr << "Only one output file possible. Ignore extra arguments" << std::endl;
 	}
 
-	if (input_files.size() > 1) {
-		std::cerr << "Only one input file possible. Ignore extra arguments" << std::endl;
-	}
-
 	if (input_files.size() == 0) {
 		std::cout << "No input file given." << std::endl;
 		return 0;
 	}
 
 	Firrtlator::Firrtlator firrtlator;
+	firrtlator.setThreads(threads > 0 ? threads : 1);
 
-	std::string::size_type pos = input_files[0].find_last_of(".");
-	if (pos == std::string::npos) {
-		std::cout << "Cannot determine the output file type" << std::endl;
-		exit(1);
+	if (!cache.empty()) {
+		firrtlator.setCache(cache, cache_limit);
+	}
+
+	std::string::size_type pos;
+	std::string ext;
+
+	if (frontend.empty()) {
+		pos = input_files[0].find_last_of(".");
+		if (pos == std::string::npos) {
+			std::cout << "Cannot determine the input file type" << std::endl;
+			exit(1);
+		}
+
+		ext = input_files[0].substr(pos+1, -1);
+
+		// Compressed files like .fir.gz are typed by the inner extension
+		if (((ext == "gz") || (ext == "zst")) && (pos > 0)) {
+			std::string::size_type inner;
+			inner = input_files[0].find_last_of(".", pos-1);
+			if (inner != std::string::npos) {
+				ext = input_files[0].substr(inner+1, -1);
+			}
+		}
+
+		frontend = firrtlator.getFrontend(ext);
 	}
 
-	std::string ext = input_files[0].substr(pos+1, -1);
+	if (!firrtlator.parseFiles(input_files, frontend)) {
+		failParsing(input_files);
+	}
 
-	if (!firrtlator.parseFile(input_files[0], firrtlator.getFrontend(ext))) {
-		std::cout << "Failed parsing " << input_files[0] << std::endl;
+	// Lazily parsed module bodies are only read by the passes and the
+	// backend, which is where their parse errors surface
+	try {
+		for (auto p : passes) {
+			firrtlator.pass(p);
+		}
+	} catch (std::runtime_error &e) {
+		std::cerr << e.what() << std::endl;
+		failParsing(input_files);
 	}
 
-	for (auto p : passes) {
-		firrtlator.pass(p);
+	if (hierarchy) {
+		printHierarchy(firrtlator);
 	}
 
 	pos = output_file.find_last_of(".");
@@ -73,7 +129,50 @@ int main(int argc, char* argv[]) {
 
 	ext = output_file.substr(pos+1, -1);
 
-	firrtlator.generate(output_file, firrtlator.getBackend(ext));
+	try {
+		firrtlator.generate(output_file, firrtlator.getBackend(ext));
+	} catch (std::runtime_error &e) {
+		std::cerr << e.what() << std::endl;
+		failParsing(input_files);
+	}
+
+	if (cache_stats) {
+		auto stats = firrtlator.getCacheStatistics();
+		std::cerr << "Cache: " << stats.hits << " hits, " << stats.misses
+				<< " misses, " << stats.stores << " stores, "
+				<< stats.evictions << " evictions, " << stats.entries
+				<< " entries, " << stats.bytes << " bytes" << std::endl;
+	}
+}
+
+void failParsing(const std::vector<std::string> &input_files) {
+	std::cout << "Failed parsing " << input_files[0];
+	if (input_files.size() > 1) {
+		std::cout << " and " << input_files.size() - 1 << " more";
+	}
+	std::cout << std::endl;
+	exit(1);
+}
+
+void printHierarchy(Firrtlator::Firrtlator &firrtlator) {
+	std::vector<::Firrtlator::Firrtlator::ModuleStatistics> list;
+
+	try {
+		list = firrtlator.getHierarchyStatistics();
+	} catch (std::runtime_error &e) {
+		std::cout << "Cannot analyze the hierarchy: " << e.what() << std::endl;
+		exit(1);
+	}
+
+	std::cout << "Hierarchy (per instance, including all instances below):" << std::endl;
+	for (auto m : list) {
+		std::cout << "  " << m.name << ": " << m.count << " instances, "
+				<< m.total.registers << " registers (" << m.total.regBits
+				<< " bits), " << m.total.memories << " memories ("
+				<< m.total.memoryBits << " bits), " << m.total.nodes
+				<< " nodes, " << m.total.instances << " instances below"
+				<< std::endl;
+	}
 }
 
 void help(void) {
@@ -81,8 +180,16 @@ void help(void) {
 	std::cout << "  <output> is an output file name. The extension hints used backend (see below)." << std::endl;
 	std::cout << std::endl;
 	std::cout << "  options:" << std::endl;
-	std::cout << "   -i <input>     Set input file. Currently only one file is supported." << std::endl;
+	std::cout << "   -i <input>     Add input file. Several inputs are parsed in parallel and" << std::endl;
+	std::cout << "                  merged, the first one names the circuit." << std::endl;
+	std::cout << "                  Files ending in .gz or .zst are decompressed while parsing." << std::endl;
+	std::cout << "   -f <frontend>  Use frontend instead of guessing it from the input file." << std::endl;
+	std::cout << "   -j <threads>   Parse with multiple threads if the frontend supports it." << std::endl;
 	std::cout << "   -p <passname>  Run pass on IR." << std::endl;
+	std::cout << "   -c <directory> Cache parsed inputs in directory and reuse them." << std::endl;
+	std::cout << "   -C <megabytes> Limit the size of the cache directory." << std::endl;
+	std::cout << "   -s             Print cache statistics." << std::endl;
+	std::cout << "   -H             Print instance counts and statistics of the hierarchy." << std::endl;
 	std::cout << std::endl;
 
 	std::vector<::Firrtlator::Firrtlator::FrontendDescriptor> fdesc;
@@ -0,0 +1,79 @@
+#!/bin/sh -e
+#
+# Reads and writes circuits nested 100000 levels deep: a chain of else
+# when and nested mux, primitive operations, subfields and subindices.
+# Both FIRRTL frontends must create the same IR, which goes through FIRB
+# and back. The stack is limited, so nothing may recurse per level.
+
+depth=100000
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+ulimit -s 1024
+
+awk -v depth=$depth 'BEGIN {
+	print "circuit deep :"
+	print "  module deep :"
+	print "    input a : UInt<1>"
+	print "    output x : UInt<8>"
+	print "    x <= UInt<8>(0)"
+	printf "    "
+	for (i = 0; i < depth; i++)
+		printf "when eq(a, UInt<1>(%d)) : x <= UInt<8>(%d)\n    else ",
+				i % 2, i % 256
+	print ": skip"
+}' > "$dir/chain.fir"
+
+awk -v depth=$depth 'BEGIN {
+	print "circuit deep :"
+	print "  module deep :"
+	print "    input a : UInt<8>"
+	print "    output x : UInt<8>"
+	printf "    x <= "
+	for (i = 0; i < depth; i++)
+		printf "mux(a, "
+	printf "a"
+	for (i = 0; i < depth; i++)
+		printf ", a)"
+	printf "\n    x <= "
+	for (i = 0; i < depth; i++)
+		printf "add("
+	printf "a"
+	for (i = 0; i < depth; i++)
+		printf ", a)"
+	printf "\n    x <= a"
+	for (i = 0; i < depth; i++)
+		printf ".f"
+	printf "\n"
+}' > "$dir/exp.fir"
+
+# The Spirit frontend does not read subindices
+awk -v depth=$depth 'BEGIN {
+	print "circuit deep :"
+	print "  module deep :"
+	print "    input a : UInt<8>"
+	print "    output x : UInt<8>"
+	printf "    x <= a"
+	for (i = 0; i < depth; i++)
+		printf "[0]"
+	printf "\n"
+}' > "$dir/index.fir"
+
+for input in chain exp; do
+	./firrtlator -f FIRRTL -i "$dir/$input.fir" "$dir/$input.firb"
+	./firrtlator -f FIRRTL-RD -i "$dir/$input.fir" "$dir/$input.rd.firb"
+	cmp "$dir/$input.firb" "$dir/$input.rd.firb"
+done
+./firrtlator -f FIRRTL-RD -i "$dir/index.fir" "$dir/index.firb"
+
+for input in chain exp index; do
+	./firrtlator -i "$dir/$input.firb" "$dir/$input.2.firb"
+	cmp "$dir/$input.firb" "$dir/$input.2.firb"
+done
+
+# Printed chains are indented per level, only the expressions are printed
+for input in exp index; do
+	./firrtlator -i "$dir/$input.firb" "$dir/$input.2.fir"
+	./firrtlator -f FIRRTL-RD -i "$dir/$input.2.fir" "$dir/$input.3.firb"
+	cmp "$dir/$input.firb" "$dir/$input.3.firb"
+done
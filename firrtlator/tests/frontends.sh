@@ -0,0 +1,17 @@
+#!/bin/sh -e
+#
+# Both FIRRTL frontends read a circuit that uses ports, registers,
+# memories, printf, stop, info locators and wide literals into the same
+# IR, the FIRB images must not differ.
+
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+input="$srcdir/tests/frontends.fir"
+
+./firrtlator -f FIRRTL -i "$input" "$dir/spirit.firb"
+./firrtlator -f FIRRTL-RD -i "$input" "$dir/rd.firb"
+cmp "$dir/spirit.firb" "$dir/rd.firb"
+
+./firrtlator -f FIRRTL-LAZY -i "$input" "$dir/lazy.firb"
+cmp "$dir/spirit.firb" "$dir/lazy.firb"
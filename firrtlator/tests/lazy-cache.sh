@@ -0,0 +1,27 @@
+#!/bin/sh -e
+#
+# A parse error in a lazily parsed module body fails the parse with and
+# without the cache. Storing in the cache parses the body, nothing may be
+# stored then.
+
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+cat > "$dir/bad.fir" << EOF
+circuit bad :
+  module bad :
+    input a : UInt<1>
+    output x : UInt<1>
+    x <= mux(a, a)
+EOF
+
+for cache in "" "-c $dir/cache"; do
+	status=0
+	./firrtlator -f FIRRTL-LAZY $cache -i "$dir/bad.fir" "$dir/bad.out.fir" \
+			> "$dir/out" 2>&1 || status=$?
+	test $status -eq 1
+	grep -q "line 5: Expected expression" "$dir/out"
+	grep -q "Failed parsing" "$dir/out"
+done
+
+test -z "$(ls -A "$dir/cache")"
@@ -41,85 +41,83 @@ public:
 	static std::vector<std::string> filetypes;
 };
 
-class Visitor : public ::Firrtlator::Visitor {
+class Visitor : public ::Firrtlator::RefVisitor {
 public:
 	Visitor(std::ostream *os);
 
 	virtual ~Visitor();
-	virtual bool visit(std::shared_ptr<Circuit>);
-	virtual void leave(std::shared_ptr<Circuit>);
+	virtual bool visit(Circuit&);
+	virtual void leave(Circuit&);
 
-	virtual bool visit(std::shared_ptr<Module>);
-	virtual void leave(std::shared_ptr<Module>);
+	virtual bool visit(Module&);
+	virtual void leave(Module&);
 
-	virtual bool visit(std::shared_ptr<Port>);
-	virtual void leave(std::shared_ptr<Port>);
+	virtual bool visit(Port&);
+	virtual void leave(Port&);
 
-	virtual bool visit(std::shared_ptr<Parameter>);
+	virtual bool visit(Parameter&);
 
-	virtual void visit(std::shared_ptr<TypeInt>);
+	virtual void visit(TypeInt&);
 
-	virtual void visit(std::shared_ptr<TypeClock>);
+	virtual void visit(TypeClock&);
 
-	virtual bool visit(std::shared_ptr<Field>);
+	virtual bool visit(Field&);
 
-	virtual bool visit(std::shared_ptr<TypeBundle>);
+	virtual bool visit(TypeBundle&);
 
-	virtual bool visit(std::shared_ptr<TypeVector>);
+	virtual bool visit(TypeVector&);
 
-	virtual bool visit(std::shared_ptr<StmtGroup>);
+	virtual bool visit(StmtGroup&);
 
-	virtual bool visit(std::shared_ptr<Wire>);
+	virtual bool visit(Wire&);
 
-	virtual bool visit(std::shared_ptr<Reg>);
+	virtual bool visit(Reg&);
 
-	virtual bool visit(std::shared_ptr<Instance>);
+	virtual bool visit(Instance&);
 
-	virtual bool visit(std::shared_ptr<Memory>);
+	virtual bool visit(Memory&);
 
-	virtual bool visit(std::shared_ptr<Node>);
+	virtual bool visit(Node&);
 
-	virtual bool visit(std::shared_ptr<Connect>);
+	virtual bool visit(Connect&);
 
-	virtual bool visit(std::shared_ptr<Invalid>);
-	virtual void leave(std::shared_ptr<Invalid>);
+	virtual bool visit(Invalid&);
+	virtual void leave(Invalid&);
 
-	virtual bool visit(std::shared_ptr<Conditional>);
+	virtual bool visit(Conditional&);
 
-	virtual bool visit(std::shared_ptr<ConditionalElse>);
+	virtual bool visit(ConditionalElse&);
 
-	virtual bool visit(std::shared_ptr<Stop>);
+	virtual bool visit(Stop&);
 
-	virtual bool visit(std::shared_ptr<Printf>);
+	virtual bool visit(Printf&);
 
-	virtual void visit(std::shared_ptr<Empty>);
+	virtual void visit(Empty&);
 
-	virtual void visit(std::shared_ptr<Reference>);
+	virtual void visit(Reference&);
 
-	virtual void visit(std::shared_ptr<Constant>);
+	virtual void visit(Constant&);
 
-	virtual bool visit(std::shared_ptr<SubField>);
+	virtual bool visit(SubField&);
 
-	virtual bool visit(std::shared_ptr<SubIndex>);
+	virtual bool visit(SubIndex&);
 
-	virtual bool visit(std::shared_ptr<SubAccess>);
+	virtual bool visit(SubAccess&);
 
-	virtual bool visit(std::shared_ptr<Mux>);
+	virtual bool visit(Mux&);
 
-	virtual bool visit(std::shared_ptr<CondValid>);
+	virtual bool visit(CondValid&);
 
-	virtual bool visit(std::shared_ptr<PrimOp>);
+	virtual bool visit(PrimOp&);
 private:
 	std::ostream *mStream;
 	std::vector<std::string> mNodes;
-	std::vector<std::tuple<std::shared_ptr<IRNode>, std::shared_ptr<IRNode>,
-		std::string> > mEdges;
+	std::vector<std::tuple<const IRNode*, const IRNode*, std::string> > mEdges;
 
-	std::map<std::shared_ptr<IRNode>, int> mNodeDictionary;
+	std::map<const IRNode*, int> mNodeDictionary;
 
-	void addNode(std::shared_ptr<IRNode> node, std::string text);
-	void addEdge(std::shared_ptr<IRNode> from, std::shared_ptr<IRNode> to,
-			std::string text);
+	void addNode(const IRNode &node, std::string text);
+	void addEdge(const IRNode &from, const IRNode *to, std::string text);
 };
 
 }
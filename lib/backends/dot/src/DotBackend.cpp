@@ -53,23 +53,23 @@ Visitor::~Visitor() {
 
 }
 
-bool Visitor::visit(std::shared_ptr<Circuit> c) {
-	addNode(c, "circuit\n"+c->getId());
+bool Visitor::visit(Circuit &c) {
+	addNode(c, "circuit\n"+c.getId());
 
-	for (auto m : c->getModules()) {
-		addEdge(c, m, "");
+	for (const auto &m : c.getModules()) {
+		addEdge(c, m.get(), "");
 	}
 
 	return true;
 }
 
-void Visitor::leave(std::shared_ptr<Circuit> c) {
-	*mStream << "diGraph " << c->getId() << " {" << indent << endl;
+void Visitor::leave(Circuit &c) {
+	*mStream << "diGraph " << c.getId() << " {" << indent << endl;
 
-	for (auto n : mNodes)
+	for (const auto &n : mNodes)
 		*mStream << n << endl;
 
-	for (auto e : mEdges) {
+	for (const auto &e : mEdges) {
 		int from = mNodeDictionary[std::get<0>(e)];
 		int to = mNodeDictionary[std::get<1>(e)];
 		std::string text = std::get<2>(e);
@@ -83,192 +83,191 @@ void Visitor::leave(std::shared_ptr<Circuit> c) {
 	*mStream << dedent << endl << "}" << endl;
 }
 
-bool Visitor::visit(std::shared_ptr<Module> m) {
-	addNode(m, "module\n"+m->getId());
+bool Visitor::visit(Module &m) {
+	addNode(m, "module\n"+m.getId());
 
-	for (auto p : m->getPorts())
-		addEdge(m, p, "");
+	for (const auto &p : m.getPorts())
+		addEdge(m, p.get(), "");
 
-	addEdge(m, m->getStmts(), "");
+	addEdge(m, m.getStmts().get(), "");
 
 	return true;
 }
 
-void Visitor::leave(std::shared_ptr<Module> m) {
+void Visitor::leave(Module &m) {
 }
 
-bool Visitor::visit(std::shared_ptr<Port> p) {
-	addNode(p, "port\n"+p->getId());
+bool Visitor::visit(Port &p) {
+	addNode(p, "port\n"+p.getId());
 
 	return true;
 }
 
-void Visitor::leave(std::shared_ptr<Port> p) {
+void Visitor::leave(Port &p) {
 }
 
-bool Visitor::visit(std::shared_ptr<Parameter> ) {
+bool Visitor::visit(Parameter &) {
 	return true;
 }
 
-void Visitor::visit(std::shared_ptr<TypeInt> t) {
+void Visitor::visit(TypeInt &t) {
 }
 
-void Visitor::visit(std::shared_ptr<TypeClock> t) {
+void Visitor::visit(TypeClock &t) {
 }
 
-bool Visitor::visit(std::shared_ptr<Field> ) {
+bool Visitor::visit(Field &) {
 	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<TypeBundle> ) {
+bool Visitor::visit(TypeBundle &) {
 	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<TypeVector> ) {
+bool Visitor::visit(TypeVector &) {
 	return true;
 }
 
 
-bool Visitor::visit(std::shared_ptr<StmtGroup> g) {
+bool Visitor::visit(StmtGroup &g) {
 	addNode(g, "stmt_group\n");
 
 	int i = 0;
-	for (auto s : *g)
-		addEdge(g, s, "[" + std::to_string(i++) + "]");
+	for (const auto &s : g)
+		addEdge(g, s.get(), "[" + std::to_string(i++) + "]");
 
 	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<Wire> w) {
-	addNode(w, "wire\n"+w->getId());
+bool Visitor::visit(Wire &w) {
+	addNode(w, "wire\n"+w.getId());
 	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<Reg> r) {
-	addNode(r, "reg\n"+r->getId());
+bool Visitor::visit(Reg &r) {
+	addNode(r, "reg\n"+r.getId());
 	return false;
 }
 
-bool Visitor::visit(std::shared_ptr<Instance> i) {
-	addNode(i, "inst:\n"+i->getId());
+bool Visitor::visit(Instance &i) {
+	addNode(i, "inst:\n"+i.getId());
 	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<Memory> m) {
-	addNode(m, "memory:\n"+m->getId());
+bool Visitor::visit(Memory &m) {
+	addNode(m, "memory:\n"+m.getId());
 	return true;
 }
-bool Visitor::visit(std::shared_ptr<Node> n) {
-	addNode(n, "node:\n"+n->getId());
+bool Visitor::visit(Node &n) {
+	addNode(n, "node:\n"+n.getId());
 	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<Connect> c) {
+bool Visitor::visit(Connect &c) {
 	addNode(c, "connect");
 
-	addEdge(c, c->getFrom(), "from");
-	c->getFrom()->accept(*this);
+	addEdge(c, c.getFrom().get(), "from");
+	c.getFrom()->accept(*this);
 
-	addEdge(c, c->getTo(), "to");
-	c->getTo()->accept(*this);
+	addEdge(c, c.getTo().get(), "to");
+	c.getTo()->accept(*this);
 
 	return false;
 }
 
-bool Visitor::visit(std::shared_ptr<Invalid> i) {
+bool Visitor::visit(Invalid &i) {
 	addNode(i, "invalid");
 	return true;
 }
 
-void Visitor::leave(std::shared_ptr<Invalid> in) {
+void Visitor::leave(Invalid &in) {
 }
 
-bool Visitor::visit(std::shared_ptr<Conditional> c) {
+bool Visitor::visit(Conditional &c) {
 	addNode(c, "conditional");
 
-	addEdge(c, c->getCondition(), "cond");
+	addEdge(c, c.getCondition().get(), "cond");
 
-	addEdge(c, c->getThen(), "then");
+	addEdge(c, c.getThen().get(), "then");
 
-	if (c->getElse())
-		addEdge(c, c->getElse(), "else");
+	if (c.getElse())
+		addEdge(c, c.getElse().get(), "else");
 
 	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<ConditionalElse> c) {
+bool Visitor::visit(ConditionalElse &c) {
 	addNode(c, "else");
 	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<Stop> s) {
+bool Visitor::visit(Stop &s) {
 	addNode(s, "stop");
 	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<Printf> p) {
+bool Visitor::visit(Printf &p) {
 	addNode(p, "printf");
 	return true;
 }
 
-void Visitor::visit(std::shared_ptr<Empty> e) {
+void Visitor::visit(Empty &e) {
 	addNode(e, "skip");
 }
 
-void Visitor::visit(std::shared_ptr<Reference> r) {
-	addNode(r, "ref\n" + r->getToString());
+void Visitor::visit(Reference &r) {
+	addNode(r, "ref\n" + r.getToString());
 }
 
-void Visitor::visit(std::shared_ptr<Constant> c) {
+void Visitor::visit(Constant &c) {
 	addNode(c, "const");
 }
 
-bool Visitor::visit(std::shared_ptr<SubField> s) {
+bool Visitor::visit(SubField &s) {
 	addNode(s, "subfield");
 	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<SubIndex> s) {
+bool Visitor::visit(SubIndex &s) {
 	addNode(s, "subindex");
 	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<SubAccess> s) {
+bool Visitor::visit(SubAccess &s) {
 	addNode(s, "subaccess");
 	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<Mux> m) {
+bool Visitor::visit(Mux &m) {
 	addNode(m, "mux");
 	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<CondValid> c) {
+bool Visitor::visit(CondValid &c) {
 	addNode(c, "condvalid");
 	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<PrimOp> op) {
-	addNode(op, op->operationName());
+bool Visitor::visit(PrimOp &op) {
+	addNode(op, op.operationName());
 
 	int i = 0;
-	for (auto o: op->getOperands())
-		addEdge(op, o, "["+std::to_string(i++)+"]");
+	for (const auto &o : op.getOperands())
+		addEdge(op, o.get(), "["+std::to_string(i++)+"]");
 
 	return true;
 }
 
-void Visitor::addNode(std::shared_ptr<IRNode> node, std::string text) {
+void Visitor::addNode(const IRNode &node, std::string text) {
 	std::string n;
 	int id = mNodes.size();
-	mNodeDictionary[node] = id;
+	mNodeDictionary[&node] = id;
 	n += std::to_string(id) + " [label=\"" + text + "\"];";
 	mNodes.push_back(n);
 }
 
-void Visitor::addEdge(std::shared_ptr<IRNode> from, std::shared_ptr<IRNode> to,
-		std::string text) {
-	mEdges.push_back(std::make_tuple(from, to, text));
+void Visitor::addEdge(const IRNode &from, const IRNode *to, std::string text) {
+	mEdges.push_back(std::make_tuple(&from, to, text));
 }
 
 }
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "FirrtlatorBackend.h"
+#include "FirbFormat.h"
+#include "StaticVisitor.h"
+
+#include <unordered_map>
+
+namespace Firrtlator {
+namespace Backend {
+namespace Firb {
+
+class Backend : public ::Firrtlator::Backend::BackendBase {
+public:
+	Backend(std::ostream &os);
+	virtual void generate(std::shared_ptr<Circuit> ir);
+	static std::string name;
+	static std::string description;
+	static std::vector<std::string> filetypes;
+};
+
+/*
+ * Writes the node records in post order: the children are written first
+ * and leave their position on a stack, from which the node takes them
+ * when it is left, so the position of a child is known when its parent is
+ * written and deep trees are written without recursion.
+ */
+class Visitor : public StaticVisitor<Visitor> {
+public:
+	// Locators are only written with infos set
+	Visitor(bool infos = true);
+
+	// Writes the image with the circuit as root
+	void write(std::ostream &os, std::shared_ptr<Circuit> circuit);
+
+	// Hash of the records of node and its children without locators, so
+	// structurally identical nodes have the same hash
+	static uint64_t structuralHash(std::shared_ptr<IRNode> node);
+
+	bool visitCircuit(Circuit &c);
+	bool visitModule(Module &m);
+	void leavePort(Port &p);
+	bool visitParameter(Parameter &p);
+	void visitTypeInt(TypeInt &t);
+	void visitTypeClock(TypeClock &t);
+	void leaveField(Field &f);
+	void leaveTypeBundle(TypeBundle &t);
+	void leaveTypeVector(TypeVector &t);
+	void leaveStmtGroup(StmtGroup &g);
+	void leaveWire(Wire &w);
+	void leaveReg(Reg &r);
+	bool visitInstance(Instance &i);
+	bool visitMemory(Memory &m);
+	void leaveNode(Node &n);
+	void leaveConnect(Connect &c);
+	void leaveInvalid(Invalid &i);
+	void leaveConditional(Conditional &c);
+	void leaveConditionalElse(ConditionalElse &e);
+	void leaveStop(Stop &s);
+	void leavePrintf(Printf &p);
+	void visitEmpty(Empty &e);
+	void visitReference(Reference &r);
+	void visitConstant(Constant &c);
+	bool visitSubField(SubField &f);
+	void leaveSubField(SubField &f);
+	void leaveSubIndex(SubIndex &i);
+	void leaveSubAccess(SubAccess &a);
+	void leaveMux(Mux &m);
+	void leaveCondValid(CondValid &v);
+	void leavePrimOp(PrimOp &p);
+private:
+	std::vector<uint32_t> mNodes;
+	std::vector<Symbol> mStrings;
+	std::unordered_map<Symbol, uint32_t> mStringIndex;
+	std::unordered_map<const Info*, uint32_t> mInfoIndex;
+	bool mInfos;
+
+	// Positions of the children written, that their parents take
+	std::vector<uint32_t> mValues;
+	// Field names of the sub-fields in progress, which are written as
+	// strings instead of records
+	std::vector<const IRNode*> mFields;
+
+	// The record in progress, with absolute child positions + 1
+	std::vector<uint32_t> mRecord;
+	std::vector<uint32_t> mRefs;
+	// All records with absolute positions, and their position and size
+	// by hash, to find identical records
+	std::vector<uint32_t> mAbsolute;
+	std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t> > mRecords;
+
+	static const uint32_t none = ~0u;
+
+	uint32_t pop();
+	uint32_t convert(std::shared_ptr<IRNode> node);
+	void begin(::Firrtlator::Firb::Kind kind, IRNode &node,
+			uint32_t flags = 0);
+	void ref(uint32_t child);
+	void refs(const std::vector<uint32_t> &children);
+	// Refers to the last n children on the stack and takes them
+	void refs(size_t n);
+	void word(uint32_t value);
+	// Writes the record and leaves its position on the stack
+	void end();
+	uint32_t string(Symbol s);
+	uint32_t string(std::shared_ptr<Info> info);
+	void strings(const std::vector<std::string> &list);
+};
+
+}
+}
+}
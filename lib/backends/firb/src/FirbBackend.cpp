@@ -0,0 +1,500 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "FirbBackend.h"
+#include "Hash.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Firrtlator {
+namespace Backend {
+namespace Firb {
+
+namespace Format = ::Firrtlator::Firb;
+
+std::string Backend::name = "FIRB";
+std::string Backend::description = "Generates binary IR images";
+std::vector<std::string> Backend::filetypes = { "firb" };
+
+REGISTER_BACKEND(Backend)
+
+Backend::Backend(std::ostream &os) : ::Firrtlator::Backend::BackendBase(os) {
+
+}
+
+void Backend::generate(std::shared_ptr<Circuit> ir) {
+	Visitor v;
+	v.write(*mStream, ir);
+}
+
+Visitor::Visitor(bool infos) : mInfos(infos) {}
+
+static uint32_t align4(uint32_t v) {
+	return (v + 3) & ~3u;
+}
+
+void Visitor::write(std::ostream &os, std::shared_ptr<Circuit> circuit) {
+	uint32_t root = convert(circuit);
+
+	std::vector<uint32_t> index;
+	uint32_t size = 0;
+	index.reserve(mStrings.size() + 1);
+	for (auto &s : mStrings) {
+		index.push_back(size);
+		size += s.str().size();
+	}
+	index.push_back(size);
+
+	Format::Header header;
+	memcpy(header.magic, Format::magic, sizeof(header.magic));
+	header.version = Format::version;
+	header.byteOrder = Format::byteOrder;
+	header.stringCount = mStrings.size();
+	header.stringIndex = sizeof(header);
+	header.stringData = header.stringIndex + index.size() * sizeof(uint32_t);
+	header.nodes = align4(header.stringData + size);
+	header.nodeWords = mNodes.size();
+	header.root = root;
+
+	os.write((const char*) &header, sizeof(header));
+	os.write((const char*) index.data(), index.size() * sizeof(uint32_t));
+	for (auto &s : mStrings)
+		os.write(s.str().data(), s.str().size());
+	os.write("\0\0\0", header.nodes - header.stringData - size);
+	os.write((const char*) mNodes.data(), mNodes.size() * sizeof(uint32_t));
+}
+
+uint64_t Visitor::structuralHash(std::shared_ptr<IRNode> node) {
+	Visitor v(false);
+	v.convert(node);
+
+	// The strings are numbered in the order of first use, which only
+	// depends on the structure as well
+	uint64_t h = hash64((const char*) v.mNodes.data(),
+			v.mNodes.size() * sizeof(uint32_t));
+	for (auto &s : v.mStrings) {
+		uint64_t size = s.str().size();
+		h = hash64((const char*) &size, sizeof(size), h);
+		h = hash64(s.str().data(), size, h);
+	}
+
+	return h;
+}
+
+uint32_t Visitor::pop() {
+	uint32_t pos = mValues.back();
+	mValues.pop_back();
+	return pos;
+}
+
+uint32_t Visitor::convert(std::shared_ptr<IRNode> node) {
+	if (!node)
+		return none;
+
+	traverse(*node);
+	return pop();
+}
+
+void Visitor::begin(Format::Kind kind, IRNode &node, uint32_t flags) {
+	Symbol id = node.getSymbol();
+	std::shared_ptr<Info> info = mInfos ? node.getInfo() : nullptr;
+
+	uint32_t head = kind | (flags << Format::FLAG_SHIFT);
+	if (!id.empty())
+		head |= Format::HAS_ID;
+	if (info)
+		head |= Format::HAS_INFO;
+
+	mRecord.clear();
+	mRefs.clear();
+	mRecord.push_back(head);
+	if (!id.empty())
+		mRecord.push_back(string(id));
+	if (info)
+		mRecord.push_back(string(info));
+}
+
+void Visitor::ref(uint32_t child) {
+	mRefs.push_back(mRecord.size());
+	mRecord.push_back((child == none) ? 0 : child + 1);
+}
+
+void Visitor::refs(const std::vector<uint32_t> &children) {
+	mRecord.push_back(children.size());
+	for (auto c : children)
+		ref(c);
+}
+
+void Visitor::refs(size_t n) {
+	mRecord.push_back(n);
+	for (auto i = mValues.end() - n; i != mValues.end(); ++i)
+		ref(*i);
+	mValues.resize(mValues.size() - n);
+}
+
+void Visitor::word(uint32_t value) {
+	mRecord.push_back(value);
+}
+
+void Visitor::end() {
+	uint64_t hash = mRecord.size();
+	for (auto w : mRecord)
+		hash = (hash ^ w) * 0x100000001b3ull;
+
+	// Identical subtrees are written once, as their children are already
+	// shared the records are identical as well
+	auto it = mRecords.find(hash);
+	if ((it != mRecords.end()) && (it->second.second == mRecord.size())
+			&& std::equal(mRecord.begin(), mRecord.end(),
+					mAbsolute.begin() + it->second.first)) {
+		mValues.push_back(it->second.first);
+		return;
+	}
+
+	uint32_t pos = mNodes.size();
+	mAbsolute.insert(mAbsolute.end(), mRecord.begin(), mRecord.end());
+	for (auto i : mRefs)
+		if (mRecord[i] != 0)
+			mRecord[i] = mRecord[i] - 1 - pos;
+	mNodes.insert(mNodes.end(), mRecord.begin(), mRecord.end());
+
+	if (it == mRecords.end())
+		mRecords[hash] = std::make_pair(pos, (uint32_t) mRecord.size());
+
+	mValues.push_back(pos);
+}
+
+uint32_t Visitor::string(Symbol s) {
+	auto it = mStringIndex.find(s);
+	if (it != mStringIndex.end())
+		return it->second;
+
+	uint32_t index = mStrings.size();
+	mStrings.push_back(s);
+	mStringIndex[s] = index;
+	return index;
+}
+
+uint32_t Visitor::string(std::shared_ptr<Info> info) {
+	// The frontends share the Info nodes of identical locators
+	auto it = mInfoIndex.find(info.get());
+	if (it != mInfoIndex.end())
+		return it->second;
+
+	uint32_t index = string(info->getValue());
+	mInfoIndex[info.get()] = index;
+	return index;
+}
+
+void Visitor::strings(const std::vector<std::string> &list) {
+	word(list.size());
+	for (auto &s : list)
+		word(string(s));
+}
+
+bool Visitor::visitCircuit(Circuit &c) {
+	for (const auto &m : c.getModules())
+		traverse(*m);
+
+	begin(Format::CIRCUIT, c);
+	refs(c.getModules().size());
+	end();
+	return false;
+}
+
+bool Visitor::visitModule(Module &m) {
+	std::vector<uint32_t> ports, params;
+	for (const auto &p : m.getPorts())
+		ports.push_back(convert(p));
+	for (const auto &p : m.getParameters())
+		params.push_back(convert(p));
+	uint32_t body = convert(m.getStmts());
+
+	begin(Format::MODULE, m,
+			m.isExternal() ? Format::FLAG_EXTERNAL : 0);
+	std::string defname = m.getDefname();
+	word(defname.empty() ? 0 : string(defname) + 1);
+	refs(ports);
+	refs(params);
+	ref(body);
+	end();
+	return false;
+}
+
+void Visitor::leavePort(Port &p) {
+	uint32_t type = pop();
+	begin(Format::PORT, p,
+			(p.getDirection() == Port::OUTPUT) ? Format::FLAG_OUTPUT : 0);
+	ref(type);
+	end();
+}
+
+bool Visitor::visitParameter(Parameter &p) {
+	begin(Format::PARAMETER, p);
+	end();
+	return false;
+}
+
+void Visitor::visitTypeInt(TypeInt &t) {
+	begin(Format::TYPE_INT, t, t.getSigned() ? Format::FLAG_SIGNED : 0);
+	word(t.getWidth());
+	end();
+}
+
+void Visitor::visitTypeClock(TypeClock &t) {
+	begin(Format::TYPE_CLOCK, t);
+	end();
+}
+
+void Visitor::leaveField(Field &f) {
+	uint32_t type = pop();
+	begin(Format::FIELD, f,
+			f.getFlip() ? Format::FLAG_FLIP : 0);
+	ref(type);
+	end();
+}
+
+void Visitor::leaveTypeBundle(TypeBundle &t) {
+	begin(Format::TYPE_BUNDLE, t);
+	refs(t.getFields().size());
+	end();
+}
+
+void Visitor::leaveTypeVector(TypeVector &t) {
+	uint32_t type = t.getType() ? pop() : none;
+	begin(Format::TYPE_VECTOR, t);
+	ref(type);
+	word(t.getSize());
+	end();
+}
+
+void Visitor::leaveStmtGroup(StmtGroup &g) {
+	begin(Format::STMT_GROUP, g);
+	refs(g.end() - g.begin());
+	end();
+}
+
+void Visitor::leaveWire(Wire &w) {
+	uint32_t type = pop();
+	begin(Format::WIRE, w);
+	ref(type);
+	end();
+}
+
+void Visitor::leaveReg(Reg &r) {
+	// The walk only visits the reset if both of its parts are set
+	bool reset = r.getResetTrigger() && r.getResetValue();
+	uint32_t value = reset ? pop() : none;
+	uint32_t trigger = reset ? pop() : none;
+	uint32_t clock = pop();
+	uint32_t type = pop();
+	if (!reset) {
+		trigger = convert(r.getResetTrigger());
+		value = convert(r.getResetValue());
+	}
+
+	begin(Format::REG, r);
+	ref(type);
+	ref(clock);
+	ref(trigger);
+	ref(value);
+	end();
+}
+
+bool Visitor::visitInstance(Instance &i) {
+	begin(Format::INSTANCE, i);
+	word(string(i.getOf()->getToSymbol()));
+	end();
+	return false;
+}
+
+bool Visitor::visitMemory(Memory &m) {
+	uint32_t dtype = convert(m.getDType());
+	begin(Format::MEMORY, m, m.getRuwflag());
+	ref(dtype);
+	word(m.getDepth());
+	word(m.getReadlatency());
+	word(m.getWritelatency());
+	strings(m.getReaders());
+	strings(m.getWriters());
+	strings(m.getReadWriters());
+	end();
+	return false;
+}
+
+void Visitor::leaveNode(Node &n) {
+	uint32_t exp = pop();
+	begin(Format::NODE, n);
+	ref(exp);
+	end();
+}
+
+void Visitor::leaveConnect(Connect &c) {
+	uint32_t from = pop();
+	uint32_t to = pop();
+	begin(Format::CONNECT, c,
+			c.getPartial() ? Format::FLAG_PARTIAL : 0);
+	ref(to);
+	ref(from);
+	end();
+}
+
+void Visitor::leaveInvalid(Invalid &i) {
+	uint32_t exp = pop();
+	begin(Format::INVALID, i);
+	ref(exp);
+	end();
+}
+
+void Visitor::leaveConditional(Conditional &c) {
+	uint32_t otherwise = c.getElse() ? pop() : none;
+	uint32_t then = pop();
+	uint32_t cond = pop();
+
+	begin(Format::CONDITIONAL, c);
+	ref(cond);
+	ref(then);
+	ref(otherwise);
+	end();
+}
+
+void Visitor::leaveConditionalElse(ConditionalElse &e) {
+	uint32_t stmts = e.getStmts() ? pop() : none;
+	begin(Format::CONDITIONAL_ELSE, e);
+	ref(stmts);
+	end();
+}
+
+void Visitor::leaveStop(Stop &s) {
+	uint32_t cond = pop();
+	uint32_t clock = pop();
+	begin(Format::STOP, s);
+	ref(clock);
+	ref(cond);
+	word(s.getCode());
+	end();
+}
+
+void Visitor::leavePrintf(Printf &p) {
+	// The arguments are on top of the clock and the condition
+	size_t args = p.getArguments().size();
+	uint32_t cond = mValues[mValues.size() - args - 1];
+	uint32_t clock = mValues[mValues.size() - args - 2];
+
+	begin(Format::PRINTF, p);
+	ref(clock);
+	ref(cond);
+	word(string(p.getFormat()));
+	refs(args);
+	mValues.resize(mValues.size() - 2);
+	end();
+}
+
+void Visitor::visitEmpty(Empty &e) {
+	begin(Format::EMPTY, e);
+	end();
+}
+
+void Visitor::visitReference(Reference &r) {
+	if (!mFields.empty() && (mFields.back() == &r)) {
+		mFields.pop_back();
+		return;
+	}
+
+	begin(Format::REFERENCE, r);
+	word(string(r.getToSymbol()));
+	end();
+}
+
+void Visitor::visitConstant(Constant &c) {
+	uint32_t type = convert(c.getType());
+	begin(Format::CONSTANT, c, c.getHint());
+	ref(type);
+	word(string(c.getLiteral()));
+	end();
+}
+
+bool Visitor::visitSubField(SubField &f) {
+	// The walk visits the field after the subtree of the bundle
+	mFields.push_back(f.getField().get());
+	return true;
+}
+
+void Visitor::leaveSubField(SubField &f) {
+	uint32_t of = pop();
+	begin(Format::SUB_FIELD, f);
+	ref(of);
+	word(string(f.getField()->getToSymbol()));
+	end();
+}
+
+void Visitor::leaveSubIndex(SubIndex &i) {
+	uint32_t of = pop();
+	begin(Format::SUB_INDEX, i);
+	ref(of);
+	word(i.getIndex());
+	end();
+}
+
+void Visitor::leaveSubAccess(SubAccess &a) {
+	uint32_t exp = pop();
+	uint32_t of = pop();
+	begin(Format::SUB_ACCESS, a);
+	ref(of);
+	ref(exp);
+	end();
+}
+
+void Visitor::leaveMux(Mux &m) {
+	uint32_t b = pop();
+	uint32_t a = pop();
+	uint32_t sel = pop();
+	begin(Format::MUX, m);
+	ref(sel);
+	ref(a);
+	ref(b);
+	end();
+}
+
+void Visitor::leaveCondValid(CondValid &v) {
+	uint32_t a = pop();
+	uint32_t sel = pop();
+	begin(Format::COND_VALID, v);
+	ref(sel);
+	ref(a);
+	end();
+}
+
+void Visitor::leavePrimOp(PrimOp &p) {
+	begin(Format::PRIMOP, p, p.getOp());
+	refs(p.getOperands().size());
+	const auto &params = p.getParameters();
+	word(params.size());
+	for (auto v : params)
+		word(v);
+	end();
+}
+
+}
+}
+}
@@ -23,10 +23,11 @@
 #pragma once
 
 #include "FirrtlatorBackend.h"
-#include "Visitor.h"
+#include "StaticVisitor.h"
 
 #include <iostream>
 #include <sstream>
+#include <utility>
 
 namespace Firrtlator {
 namespace Backend {
@@ -41,82 +42,108 @@ public:
 	static std::vector<std::string> filetypes;
 };
 
-class Visitor : public ::Firrtlator::Visitor {
+/*
+ * Prints the nodes as they are walked. The separators between the
+ * children of a node are printed by the children themselves, which know
+ * their position from the stack of nodes whose children are printed, so
+ * the walk does not need to recurse.
+ */
+class Visitor : public StaticVisitor<Visitor> {
 public:
 	Visitor(std::basic_stringstream<char, std::char_traits<char> > *os);
 
-	virtual ~Visitor();
-	virtual bool visit(std::shared_ptr<Circuit>);
-	virtual void leave(std::shared_ptr<Circuit>);
-
-	virtual bool visit(std::shared_ptr<Module>);
-	virtual void leave(std::shared_ptr<Module>);
+	bool visitCircuit(Circuit&);
+	void leaveCircuit(Circuit&);
 
-	virtual bool visit(std::shared_ptr<Port>);
-	virtual void leave(std::shared_ptr<Port>);
+	bool visitModule(Module&);
+	void leaveModule(Module&);
 
-	virtual bool visit(std::shared_ptr<Parameter>);
+	bool visitPort(Port&);
+	void leavePort(Port&);
 
-	virtual void visit(std::shared_ptr<TypeInt>);
+	void visitTypeInt(TypeInt&);
 
-	virtual void visit(std::shared_ptr<TypeClock>);
+	void visitTypeClock(TypeClock&);
 
-	virtual bool visit(std::shared_ptr<Field>);
+	bool visitField(Field&);
+	void leaveField(Field&);
 
-	virtual bool visit(std::shared_ptr<TypeBundle>);
+	bool visitTypeBundle(TypeBundle&);
+	void leaveTypeBundle(TypeBundle&);
 
-	virtual bool visit(std::shared_ptr<TypeVector>);
-	virtual void leave(std::shared_ptr<TypeVector>);
+	bool visitTypeVector(TypeVector&);
+	void leaveTypeVector(TypeVector&);
 
-	virtual bool visit(std::shared_ptr<StmtGroup>);
-	virtual void leave(std::shared_ptr<StmtGroup>);
+	bool visitStmtGroup(StmtGroup&);
+	void leaveStmtGroup(StmtGroup&);
 
-	virtual bool visit(std::shared_ptr<Wire>);
-	virtual void leave(std::shared_ptr<Wire>);
+	bool visitWire(Wire&);
+	void leaveWire(Wire&);
 
-	virtual bool visit(std::shared_ptr<Reg>);
+	bool visitReg(Reg&);
+	void leaveReg(Reg&);
 
-	virtual bool visit(std::shared_ptr<Instance>);
-	virtual void leave(std::shared_ptr<Instance>);
+	bool visitInstance(Instance&);
+	void leaveInstance(Instance&);
 
-	virtual bool visit(std::shared_ptr<Memory>);
+	bool visitMemory(Memory&);
 
-	virtual bool visit(std::shared_ptr<Node>);
-	virtual void leave(std::shared_ptr<Node>);
+	bool visitNode(Node&);
+	void leaveNode(Node&);
 
-	virtual bool visit(std::shared_ptr<Connect>);
+	bool visitConnect(Connect&);
+	void leaveConnect(Connect&);
 
-	virtual bool visit(std::shared_ptr<Invalid>);
-	virtual void leave(std::shared_ptr<Invalid>);
+	bool visitInvalid(Invalid&);
+	void leaveInvalid(Invalid&);
 
-	virtual bool visit(std::shared_ptr<Conditional>);
+	bool visitConditional(Conditional&);
+	void leaveConditional(Conditional&);
 
-	virtual bool visit(std::shared_ptr<ConditionalElse>);
+	bool visitConditionalElse(ConditionalElse&);
+	void leaveConditionalElse(ConditionalElse&);
 
-	virtual bool visit(std::shared_ptr<Stop>);
+	bool visitStop(Stop&);
+	void leaveStop(Stop&);
 
-	virtual bool visit(std::shared_ptr<Printf>);
+	bool visitPrintf(Printf&);
+	void leavePrintf(Printf&);
 
-	virtual void visit(std::shared_ptr<Empty>);
+	void visitEmpty(Empty&);
 
-	virtual void visit(std::shared_ptr<Reference>);
+	void visitReference(Reference&);
 
-	virtual void visit(std::shared_ptr<Constant>);
+	void visitConstant(Constant&);
 
-	virtual bool visit(std::shared_ptr<SubField>);
+	bool visitSubField(SubField&);
+	void leaveSubField(SubField&);
 
-	virtual bool visit(std::shared_ptr<SubIndex>);
+	bool visitSubIndex(SubIndex&);
+	void leaveSubIndex(SubIndex&);
 
-	virtual bool visit(std::shared_ptr<SubAccess>);
+	bool visitSubAccess(SubAccess&);
+	void leaveSubAccess(SubAccess&);
 
-	virtual bool visit(std::shared_ptr<Mux>);
+	bool visitMux(Mux&);
+	void leaveMux(Mux&);
 
-	virtual bool visit(std::shared_ptr<CondValid>);
+	bool visitCondValid(CondValid&);
+	void leaveCondValid(CondValid&);
 
-	virtual bool visit(std::shared_ptr<PrimOp>);
+	bool visitPrimOp(PrimOp&);
+	void leavePrimOp(PrimOp&);
 private:
 	std::basic_stringstream<char> *mStream;
-	void outputInfo(std::shared_ptr<IRNode>);
+
+	// The nodes whose children are printed, and the number of children
+	// printed so far
+	std::vector<std::pair<IRNode*, size_t> > mParents;
+
+	// Prints the separator in front of the next child of the parent
+	void separate();
+	void open(IRNode &n);
+	void close();
+	void outputInfo(IRNode&);
 };
 
 }
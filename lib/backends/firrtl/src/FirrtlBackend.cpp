@@ -43,7 +43,7 @@ void Backend::generate(std::shared_ptr<Circuit> ir) {
 	std::basic_stringstream<char> sstream;
 	Visitor v(&sstream);
 
-	ir->accept(v);
+	v.traverse(ir);
 
 	*mStream << sstream.str();
 }
@@ -52,193 +52,266 @@ Visitor::Visitor(std::basic_stringstream<char, std::char_traits<char> > *os) {
 	mStream = os;
 }
 
-Visitor::~Visitor() {
+void Visitor::separate() {
+	if (mParents.empty())
+		return;
 
+	IRNode &parent = *mParents.back().first;
+	size_t i = mParents.back().second++;
+
+	if (i == 0)
+		return;
+
+	switch (parent.getKind()) {
+	case NodeKind::TypeBundle:
+	case NodeKind::Stop:
+	case NodeKind::Mux:
+	case NodeKind::CondValid:
+	case NodeKind::PrimOp:
+		*mStream << ", ";
+		break;
+	case NodeKind::Reg:
+		if (i == 1)
+			*mStream << " ";
+		else if (i == 2)
+			*mStream << " with : ( reset => ( ";
+		else
+			*mStream << ", ";
+		break;
+	case NodeKind::Connect:
+		if (static_cast<Connect&>(parent).getPartial())
+			*mStream << " <- ";
+		else
+			*mStream << " <= ";
+		break;
+	case NodeKind::Conditional:
+		// Between the condition and the statements, and before the else
+		if (i == 1) {
+			*mStream << " :";
+			outputInfo(parent);
+			*mStream << indent << endl;
+		} else {
+			*mStream << dedent;
+		}
+		break;
+	case NodeKind::Printf:
+		*mStream << ", ";
+		if (i == 2)
+			*mStream << "\"" << static_cast<Printf&>(parent).getFormat()
+				<< "\", ";
+		break;
+	case NodeKind::SubField:
+		*mStream << ".";
+		break;
+	case NodeKind::SubAccess:
+		*mStream << "[";
+		break;
+	default:
+		break;
+	}
+}
+
+void Visitor::open(IRNode &n) {
+	mParents.push_back(std::make_pair(&n, 0));
+}
+
+void Visitor::close() {
+	mParents.pop_back();
 }
 
-bool Visitor::visit(std::shared_ptr<Circuit> c) {
-	*mStream << "circuit " << c->getId() << " :";
+bool Visitor::visitCircuit(Circuit &c) {
+	separate();
+	*mStream << "circuit " << c.getId() << " :";
 
 	outputInfo(c);
 
 	*mStream << indent << endl;
+	open(c);
 	return true;
 }
 
-void Visitor::leave(std::shared_ptr<Circuit> c) {
+void Visitor::leaveCircuit(Circuit &c) {
+	close();
 	*mStream << dedent;
 }
 
-bool Visitor::visit(std::shared_ptr<Module> m) {
-	bool ext = m->isExternal();
+bool Visitor::visitModule(Module &m) {
+	bool ext = m.isExternal();
 
-	*mStream << (ext ? "extmodule " : "module ") << m->getId() << " :";
+	separate();
+	*mStream << (ext ? "extmodule " : "module ") << m.getId() << " :";
 
 	outputInfo(m);
 
 	*mStream << indent << endl;
+	open(m);
 	return true;
 }
 
-void Visitor::leave(std::shared_ptr<Module> m) {
+void Visitor::leaveModule(Module &m) {
+	close();
 	*mStream << dedent;
 }
 
-bool Visitor::visit(std::shared_ptr<Port> p) {
-	if (p->getDirection() == Port::INPUT)
+bool Visitor::visitPort(Port &p) {
+	separate();
+	if (p.getDirection() == Port::INPUT)
 		*mStream << "input ";
 	else
 		*mStream << "output ";
-	*mStream << p->getId() << " : ";
+	*mStream << p.getId() << " : ";
 
+	open(p);
 	return true;
 }
 
-void Visitor::leave(std::shared_ptr<Port> p) {
+void Visitor::leavePort(Port &p) {
+	close();
 	outputInfo(p);
 
 	*mStream << endl;
 }
 
-bool Visitor::visit(std::shared_ptr<Parameter> ) {
-	return true;
-}
-
-void Visitor::visit(std::shared_ptr<TypeInt> t) {
-	if (t->getSigned())
+void Visitor::visitTypeInt(TypeInt &t) {
+	separate();
+	if (t.getSigned())
 		*mStream <<	"SInt";
 	else
 		*mStream << "UInt";
 
-	*mStream << "<" << t->getWidth() << ">";
+	*mStream << "<" << t.getWidth() << ">";
 }
 
-void Visitor::visit(std::shared_ptr<TypeClock> t) {
+void Visitor::visitTypeClock(TypeClock &t) {
+	separate();
 	*mStream << "Clock";
 }
 
-bool Visitor::visit(std::shared_ptr<Field> f) {
-	if (f->getFlip())
+bool Visitor::visitField(Field &f) {
+	separate();
+	if (f.getFlip())
 		*mStream << "flip ";
 
-	*mStream << f->getId();
+	*mStream << f.getId();
 	*mStream << " : ";
 
+	open(f);
 	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<TypeBundle> t) {
-	*mStream << "{";
-
-	auto fields = t->getFields();
-
-	if (fields.size() > 0) {
-		fields[0]->accept(*this);
-		fields.erase(fields.begin());
-	}
+void Visitor::leaveField(Field &f) {
+	close();
+}
 
-	for (auto f : fields) {
-		*mStream << ", ";
-		f->accept(*this);
-	}
+bool Visitor::visitTypeBundle(TypeBundle &t) {
+	separate();
+	*mStream << "{";
+	open(t);
+	return true;
+}
 
+void Visitor::leaveTypeBundle(TypeBundle &t) {
+	close();
 	*mStream << " }";
-	return false;
 }
 
-bool Visitor::visit(std::shared_ptr<TypeVector> ) {
+bool Visitor::visitTypeVector(TypeVector &t) {
+	separate();
+	open(t);
 	return true;
 }
 
-void Visitor::leave(std::shared_ptr<TypeVector> t) {
-	*mStream << "[" << std::to_string(t->getSize()) << "]";
+void Visitor::leaveTypeVector(TypeVector &t) {
+	close();
+	*mStream << "[" << std::to_string(t.getSize()) << "]";
 }
 
-bool Visitor::visit(std::shared_ptr<StmtGroup> g) {
+bool Visitor::visitStmtGroup(StmtGroup &g) {
+	separate();
+	open(g);
 	return true;
 }
 
-void Visitor::leave(std::shared_ptr<StmtGroup> g) {
-
+void Visitor::leaveStmtGroup(StmtGroup &g) {
+	close();
 }
 
-bool Visitor::visit(std::shared_ptr<Wire> w) {
-	*mStream << "wire " << w->getId() << " : ";
+bool Visitor::visitWire(Wire &w) {
+	separate();
+	*mStream << "wire " << w.getId() << " : ";
+	open(w);
 	return true;
 }
 
-void Visitor::leave(std::shared_ptr<Wire> w) {
+void Visitor::leaveWire(Wire &w) {
+	close();
 	*mStream << " ";
 	outputInfo(w);
 	*mStream << endl;
 }
 
-bool Visitor::visit(std::shared_ptr<Reg> r) {
-	std::shared_ptr<Type> type = r->getType();
-	std::shared_ptr<Expression> clk = r->getClock();
-	std::shared_ptr<Expression> rtrig = r->getResetTrigger();
-	std::shared_ptr<Expression> rval = r->getResetValue();
-	*mStream << "reg " << r->getId() << " : ";
-
-	type->accept(*this);
-
-	*mStream << " ";
+bool Visitor::visitReg(Reg &r) {
+	separate();
+	*mStream << "reg " << r.getId() << " : ";
+	open(r);
+	return true;
+}
 
-	clk->accept(*this);
+void Visitor::leaveReg(Reg &r) {
+	close();
 
-	if (rtrig && rval) {
-		*mStream << " with : ( reset => ( ";
-		rtrig->accept(*this);
-		*mStream << ", ";
-		rval->accept(*this);
+	if (r.getResetTrigger() && r.getResetValue())
 		*mStream << " ) ";
-	}
 
 	*mStream << ")";
 
 	outputInfo(r);
 
 	*mStream << endl;
-
-	return false;
 }
 
-bool Visitor::visit(std::shared_ptr<Instance> inst) {
-	*mStream << "inst " << inst->getId() << " of ";
+bool Visitor::visitInstance(Instance &inst) {
+	separate();
+	*mStream << "inst " << inst.getId() << " of ";
+	open(inst);
 	return true;
 }
 
-void Visitor::leave(std::shared_ptr<Instance> inst) {
+void Visitor::leaveInstance(Instance &inst) {
+	close();
 	*mStream << " ";
 	outputInfo(inst);
 	*mStream << endl;
 }
 
-bool Visitor::visit(std::shared_ptr<Memory> m) {
-	*mStream << "mem " << m->getId() << " : (";
+bool Visitor::visitMemory(Memory &m) {
+	separate();
+	*mStream << "mem " << m.getId() << " : (";
 	outputInfo(m);
 	*mStream << indent << endl;
 
 	*mStream << "data-type => ";
-	m->getDType()->accept(*this);
+	open(m);
+	traverse(m.getDType());
+	close();
 	*mStream << endl;
-	*mStream << "depth => " << std::to_string(m->getDepth()) << endl;
-	*mStream << "read-latency => " << std::to_string(m->getReadlatency()) << endl;
-	*mStream << "write-latency => " << std::to_string(m->getWritelatency()) << endl;
+	*mStream << "depth => " << std::to_string(m.getDepth()) << endl;
+	*mStream << "read-latency => " << std::to_string(m.getReadlatency()) << endl;
+	*mStream << "write-latency => " << std::to_string(m.getWritelatency()) << endl;
 	*mStream << "read-under-write => ";
-	switch (m->getRuwflag()) {
+	switch (m.getRuwflag()) {
 	case Memory::RuwFlag::OLD: *mStream << "old" << endl; break;
 	case Memory::RuwFlag::NEW: *mStream << "new" << endl; break;
 	default: *mStream << "undefined" << endl; break;
 	}
 
-	for (auto r : m->getReaders())
+	for (const auto &r : m.getReaders())
 		*mStream << "reader => " << r << endl;
 
-	for (auto w : m->getWriters())
+	for (const auto &w : m.getWriters())
 		*mStream << "writer => " << w << endl;
 
-	for (auto rw : m->getReadWriters())
+	for (const auto &rw : m.getReadWriters())
 		*mStream << "readwriter => " << rw << endl;
 
 	*mStream << ")" << dedent << endl;
@@ -246,182 +319,206 @@ bool Visitor::visit(std::shared_ptr<Memory> m) {
 	return false;
 }
 
-bool Visitor::visit(std::shared_ptr<Node> n) {
-	*mStream << "node " << n->getId() << " = ";
+bool Visitor::visitNode(Node &n) {
+	separate();
+	*mStream << "node " << n.getId() << " = ";
+	open(n);
 	return true;
 }
 
-void Visitor::leave(std::shared_ptr<Node> n) {
+void Visitor::leaveNode(Node &n) {
+	close();
 	*mStream << " ";
 	outputInfo(n);
 	*mStream << endl;
 }
 
-bool Visitor::visit(std::shared_ptr<Connect> c) {
-	std::shared_ptr<Expression> from, to;
-
-	from = c->getFrom();
-	to = c->getTo();
-
-	to->accept(*this);
-
-	if (c->getPartial())
-		*mStream << " <- ";
-	else
-		*mStream << " <= ";
-
-	from->accept(*this);
+bool Visitor::visitConnect(Connect &c) {
+	separate();
+	open(c);
+	return true;
+}
 
+void Visitor::leaveConnect(Connect &c) {
+	close();
 	outputInfo(c);
 
 	*mStream << endl;
-
-	return false;
 }
 
-bool Visitor::visit(std::shared_ptr<Invalid> ) {
+bool Visitor::visitInvalid(Invalid &i) {
+	separate();
+	open(i);
 	return true;
 }
 
-void Visitor::leave(std::shared_ptr<Invalid> i) {
+void Visitor::leaveInvalid(Invalid &i) {
+	close();
 	*mStream << " is invalid";
 	outputInfo(i);
 	*mStream << endl;
 }
 
-bool Visitor::visit(std::shared_ptr<Conditional> c) {
+bool Visitor::visitConditional(Conditional &c) {
+	separate();
 	*mStream << "when ";
-	c->getCondition()->accept(*this);
-	*mStream << " :";
-	outputInfo(c);
-	*mStream << indent << endl;
-
-	c->getThen()->accept(*this);
-
-	*mStream << dedent;
+	open(c);
+	return true;
+}
 
-	if (c->getElse())
-		c->getElse()->accept(*this);
+void Visitor::leaveConditional(Conditional &c) {
+	close();
 
-	return false;
+	// With an else the statements were closed in front of it
+	if (!c.getElse())
+		*mStream << dedent;
 }
 
-bool Visitor::visit(std::shared_ptr<ConditionalElse> e) {
+bool Visitor::visitConditionalElse(ConditionalElse &e) {
+	separate();
 	*mStream << "else :";
 	outputInfo(e);
 	*mStream << indent << endl;
 
-	e->getStmts()->accept(*this);
+	open(e);
+	return true;
+}
 
+void Visitor::leaveConditionalElse(ConditionalElse &e) {
+	close();
 	*mStream << dedent;
+}
 
+bool Visitor::visitStop(Stop &s) {
+	separate();
+	*mStream << "stop(";
+	open(s);
 	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<Stop> s) {
-	*mStream << "stop(";
-	s->getClock()->accept(*this);
-	*mStream << ", ";
-	s->getCondition()->accept(*this);
-	*mStream << ", " << std::to_string(s->getCode());
+void Visitor::leaveStop(Stop &s) {
+	close();
+	*mStream << ", " << std::to_string(s.getCode());
 	*mStream << ")";
 	outputInfo(s);
 	*mStream << endl;
-	return false;
 }
 
-bool Visitor::visit(std::shared_ptr<Printf> p) {
+bool Visitor::visitPrintf(Printf &p) {
+	separate();
 	*mStream << "printf(";
-	p->getClock()->accept(*this);
-	*mStream << ", ";
-	p->getCondition()->accept(*this);
-	*mStream << ", \"" << p->getFormat() << "\")" << endl;
-	return false;
+	open(p);
+	return true;
 }
 
-void Visitor::visit(std::shared_ptr<Empty> e) {
+void Visitor::leavePrintf(Printf &p) {
+	close();
+
+	// The format is printed in front of the arguments
+	if (p.getArguments().empty())
+		*mStream << ", \"" << p.getFormat() << "\"";
+	*mStream << ")";
+	outputInfo(p);
+	*mStream << endl;
+}
+
+void Visitor::visitEmpty(Empty &e) {
+	separate();
 	*mStream << "skip";
 	outputInfo(e);
 	*mStream << endl;
 }
 
-void Visitor::visit(std::shared_ptr<Reference> r) {
-	*mStream << r->getToString();
+void Visitor::visitReference(Reference &r) {
+	separate();
+	*mStream << r.getToString();
 }
 
-void Visitor::visit(std::shared_ptr<Constant> c) {
-	*mStream << c->getString();
+void Visitor::visitConstant(Constant &c) {
+	separate();
+	*mStream << c.getString();
 }
 
-bool Visitor::visit(std::shared_ptr<SubField> f) {
-	f->getOf()->accept(*this);
-	*mStream << ".";
-	f->getField()->accept(*this);
+bool Visitor::visitSubField(SubField &f) {
+	separate();
+	open(f);
+	return true;
+}
 
-	return false;
+void Visitor::leaveSubField(SubField &f) {
+	close();
+}
+
+bool Visitor::visitSubIndex(SubIndex &i) {
+	separate();
+	open(i);
+	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<SubIndex> i) {
-	i->getOf()->accept(*this);
-	*mStream << "[" << std::to_string(i->getIndex()) << "]";
+void Visitor::leaveSubIndex(SubIndex &i) {
+	close();
+	*mStream << "[" << std::to_string(i.getIndex()) << "]";
+}
 
-	return false;
+bool Visitor::visitSubAccess(SubAccess &a) {
+	separate();
+	open(a);
+	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<SubAccess> a) {
-	a->getOf()->accept(*this);
-	*mStream << "[";
-	a->getExp()->accept(*this);
+void Visitor::leaveSubAccess(SubAccess &a) {
+	close();
 	*mStream << "]";
-	return false;
 }
 
-bool Visitor::visit(std::shared_ptr<Mux> m) {
+bool Visitor::visitMux(Mux &m) {
+	separate();
 	*mStream << "mux(";
-	m->getSel()->accept(*this);
-	*mStream << ", ";
-	m->getA()->accept(*this);
-	*mStream << ", ";
-	m->getB()->accept(*this);
-	*mStream << ")";
-
-	return false;
+	open(m);
+	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<CondValid> c) {
-	*mStream << "mux(";
-	c->getSel()->accept(*this);
-	*mStream << ", ";
-	c->getA()->accept(*this);
+void Visitor::leaveMux(Mux &m) {
+	close();
 	*mStream << ")";
+}
 
-	return false;
+bool Visitor::visitCondValid(CondValid &c) {
+	separate();
+	*mStream << "mux(";
+	open(c);
+	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<PrimOp> op) {
-	*mStream << op->operationName() << "(";
+void Visitor::leaveCondValid(CondValid &c) {
+	close();
+	*mStream << ")";
+}
 
-	auto ops = op->getOperands();
-	auto params = op->getParameters();
+bool Visitor::visitPrimOp(PrimOp &op) {
+	separate();
+	*mStream << op.operationName() << "(";
+	open(op);
+	return true;
+}
 
-	ops[0]->accept(*this);
-	ops.erase(ops.begin());
+void Visitor::leavePrimOp(PrimOp &op) {
+	close();
 
-	for (auto o : ops) {
-		*mStream << ", ";
-		o->accept(*this);
-	}
+	for (auto p : op.getParameters())
+		*mStream << ", " << std::to_string(p);
 
 	*mStream << ")";
-
-	return false;
 }
 
-void Visitor::outputInfo(std::shared_ptr<IRNode> n) {
-	std::shared_ptr<Info> info = n->getInfo();
+void Visitor::outputInfo(IRNode &n) {
+	std::shared_ptr<Info> info = n.getInfo();
 
-	if (info)
-		*mStream << " @[" << info->getValue() << "]";
+	if (info) {
+		*mStream << " @[";
+		info->print(*mStream);
+		*mStream << "]";
+	}
 }
 
 }
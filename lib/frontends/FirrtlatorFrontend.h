@@ -25,6 +25,7 @@
 #include <memory>
 #include <string>
 #include <fstream>
+#include <unordered_map>
 
 #include "IR.h"
 #include "Firrtlator.h"
@@ -35,11 +36,28 @@ namespace Frontend {
 class FrontendBase {
 public:
     virtual ~FrontendBase();
-    virtual bool parseString(std::string::const_iterator begin,
-                             std::string::const_iterator end) = 0;
+    virtual bool parseString(const char *begin, const char *end) = 0;
     virtual std::shared_ptr<Circuit> getIR();
+    void setThreads(unsigned threads);
+    // Owner of the input buffer, if any. Frontends that access the input
+    // after parseString() keep a reference to it.
+    void setInputOwner(std::shared_ptr<const void> owner);
 protected:
     std::shared_ptr<Circuit> mIR;
+    unsigned mThreads = 1;
+    std::shared_ptr<const void> mInputOwner;
+};
+
+// Returns the same Info node for all identical locators of one parse
+class InfoCache {
+public:
+	std::shared_ptr<Info> get(const char *begin, const char *end);
+	std::shared_ptr<Info> get(const std::string &value);
+private:
+	struct Hash {
+		size_t operator()(const Info &info) const { return info.hash(); }
+	};
+	std::unordered_map<Info, std::shared_ptr<Info>, Hash> mInfos;
 };
 
 class FrontendFactory
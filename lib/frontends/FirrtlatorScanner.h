@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <vector>
+
+namespace Firrtlator {
+namespace Frontend {
+namespace Scanner {
+
+/*
+ * Bulk scanning of the input buffer for the tokenizers. The functions use
+ * SSE2 or AVX2 where the CPU supports it (selected at runtime) and fall
+ * back to plain loops otherwise.
+ */
+
+// Returns the first occurrence of c in [begin, end) or end
+const char *findByte(const char *begin, const char *end, char c);
+
+// Returns the first character in [begin, end) that is neither a space nor
+// a tab, or end
+const char *skipBlanks(const char *begin, const char *end);
+
+// Returns the start of all lines in [begin, end) that declare a module or
+// an external module. As those are keywords, no other line starts with
+// them and the modules can be parsed independently from these offsets.
+std::vector<const char*> findModules(const char *begin, const char *end);
+
+}
+}
+}
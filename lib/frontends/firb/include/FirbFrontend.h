@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "FirrtlatorFrontend.h"
+#include "FirbFormat.h"
+
+#include <mutex>
+
+namespace Firrtlator {
+namespace Frontend {
+namespace Firb {
+
+/*
+ * View of one node record in the image. Fields are read in order with
+ * next() and child(), nothing is copied.
+ */
+class Record {
+public:
+	Record(const uint32_t *begin, const uint32_t *end, uint32_t offset);
+
+	::Firrtlator::Firb::Kind kind() const { return mKind; }
+	uint32_t flags() const { return mFlags; }
+	bool hasId() const { return mHasId; }
+	uint32_t id() const { return mId; }
+	bool hasInfo() const { return mHasInfo; }
+	uint32_t info() const { return mInfo; }
+
+	uint32_t next();
+	// Whether the next field references a child, 0 stands for none
+	bool hasChild() const;
+	// Reads a child reference and returns the offset of the child
+	uint32_t childOffset();
+	Record child();
+private:
+	const uint32_t *mBegin;
+	const uint32_t *mEnd;
+	uint32_t mOffset;
+	uint32_t mCursor;
+	::Firrtlator::Firb::Kind mKind;
+	uint32_t mFlags;
+	bool mHasId;
+	bool mHasInfo;
+	uint32_t mId;
+	uint32_t mInfo;
+};
+
+/*
+ * Creates the IR from an image. The circuit, the modules and their ports
+ * are created when the image is loaded, the statements of a module when
+ * they are accessed first. Identifiers and locators are created once per
+ * string of the image.
+ */
+class Loader : public std::enable_shared_from_this<Loader> {
+public:
+	Loader(const char *begin, const char *end,
+			std::shared_ptr<const void> owner);
+
+	std::shared_ptr<Circuit> load();
+private:
+	std::shared_ptr<const void> mOwner;
+	// Copy of the image if the buffer was not aligned
+	std::vector<uint32_t> mCopy;
+	const char *mStrings;
+	const uint32_t *mStringIndex;
+	uint32_t mStringCount;
+	const uint32_t *mNodes;
+	uint32_t mNodeWords;
+	uint32_t mRoot;
+
+	std::vector<Symbol> mSymbols;
+	std::vector<std::shared_ptr<Info> > mInfos;
+	std::mutex mMutex;
+
+	Record record(uint32_t offset);
+	Symbol symbol(uint32_t index);
+	Symbol id(const Record &r);
+	std::string string(uint32_t index);
+	void setInfo(Record &r, std::shared_ptr<IRNode> node);
+
+	// Nodes loaded by loadNode() whose parent is not created yet, the
+	// children of the created record start at mChild
+	std::vector<std::shared_ptr<IRNode> > mLoaded;
+	size_t mChild;
+
+	std::shared_ptr<Module> loadModule(Record r);
+	std::shared_ptr<Port> loadPort(Record r);
+	template <typename T> std::shared_ptr<T> load(uint32_t offset);
+	std::shared_ptr<IRNode> loadNode(uint32_t offset);
+	template <typename T> std::shared_ptr<T> child(Record &r);
+	std::shared_ptr<IRNode> create(Record &r);
+	std::shared_ptr<Type> createType(Record &r);
+	std::shared_ptr<Stmt> createStmt(Record &r);
+	std::shared_ptr<Expression> createExp(Record &r);
+	std::vector<std::string> loadStrings(Record &r);
+};
+
+class Frontend : public ::Firrtlator::Frontend::FrontendBase {
+public:
+	virtual bool parseString(const char *begin, const char *end);
+	static std::string name;
+	static std::string description;
+	static std::vector<std::string> filetypes;
+};
+
+}
+}
+}
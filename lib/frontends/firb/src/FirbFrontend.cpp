@@ -0,0 +1,559 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "FirbFrontend.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace Firrtlator {
+namespace Frontend {
+namespace Firb {
+
+namespace Format = ::Firrtlator::Firb;
+
+std::string Frontend::name = "FIRB";
+std::string Frontend::description = "Reads binary IR images";
+std::vector<std::string> Frontend::filetypes = { "firb" };
+
+REGISTER_FRONTEND(Frontend)
+
+// Does not build a message string on every call, as the checks are done
+// for every field that is read
+static inline void check(bool cond, const char *msg) {
+	if (!cond)
+		throw std::runtime_error(msg);
+}
+
+Record::Record(const uint32_t *begin, const uint32_t *end, uint32_t offset)
+: mBegin(begin), mEnd(end), mOffset(offset), mCursor(offset), mId(0),
+  mInfo(0) {
+	uint32_t head = next();
+	mKind = (Format::Kind) (head & Format::KIND_MASK);
+	mFlags = head >> Format::FLAG_SHIFT;
+	mHasId = head & Format::HAS_ID;
+	mHasInfo = head & Format::HAS_INFO;
+	if (mHasId)
+		mId = next();
+	if (mHasInfo)
+		mInfo = next();
+}
+
+uint32_t Record::next() {
+	check(mCursor < (uint32_t) (mEnd - mBegin), "Truncated node");
+	return mBegin[mCursor++];
+}
+
+bool Record::hasChild() const {
+	check(mCursor < (uint32_t) (mEnd - mBegin), "Truncated node");
+	return mBegin[mCursor] != 0;
+}
+
+uint32_t Record::childOffset() {
+	// Children are written before their parents, which also rules out
+	// cycles in corrupt images
+	uint32_t offset = mOffset + next();
+	check(offset < mOffset, "Invalid child reference");
+	return offset;
+}
+
+Record Record::child() {
+	return Record(mBegin, mEnd, childOffset());
+}
+
+Loader::Loader(const char *begin, const char *end,
+		std::shared_ptr<const void> owner)
+: mOwner(owner), mChild(0) {
+	size_t size = end - begin;
+
+	// The tables are accessed in place, which needs aligned words
+	if (!owner || ((uintptr_t) begin % sizeof(uint32_t) != 0)) {
+		mCopy.resize((size + 3) / 4);
+		if (size > 0)
+			memcpy(mCopy.data(), begin, size);
+		begin = (const char*) mCopy.data();
+	}
+
+	Format::Header header;
+	check(size >= sizeof(header), "Input too short");
+	memcpy(&header, begin, sizeof(header));
+
+	check(memcmp(header.magic, Format::magic, sizeof(header.magic)) == 0,
+			"Not a FIRB image");
+	check(header.version == Format::version, "Unsupported version");
+	check(header.byteOrder == Format::byteOrder,
+			"Image was written with a different byte order");
+
+	check((header.stringIndex % 4 == 0) && (header.nodes % 4 == 0),
+			"Unaligned tables");
+	check(header.stringIndex + (header.stringCount + 1ull) * 4
+			<= header.stringData, "Invalid string table");
+	check(header.stringData <= header.nodes, "Invalid string table");
+	check(header.nodes + header.nodeWords * 4ull <= size,
+			"Invalid node table");
+	check(header.root < header.nodeWords, "Invalid root");
+
+	mStringIndex = (const uint32_t*) (begin + header.stringIndex);
+	mStringCount = header.stringCount;
+	mStrings = begin + header.stringData;
+	check(mStringIndex[mStringCount]
+			<= header.nodes - header.stringData, "Invalid string table");
+
+	mNodes = (const uint32_t*) (begin + header.nodes);
+	mNodeWords = header.nodeWords;
+	mRoot = header.root;
+
+	mSymbols.resize(mStringCount);
+	mInfos.resize(mStringCount);
+}
+
+Record Loader::record(uint32_t offset) {
+	return Record(mNodes, mNodes + mNodeWords, offset);
+}
+
+Symbol Loader::symbol(uint32_t index) {
+	check(index < mStringCount, "Invalid string reference");
+
+	if (mSymbols[index].empty()) {
+		uint32_t first = mStringIndex[index];
+		uint32_t last = mStringIndex[index + 1];
+		check((first <= last) && (last <= mStringIndex[mStringCount]),
+				"Invalid string table");
+		mSymbols[index] = Symbol(mStrings + first, mStrings + last);
+	}
+
+	return mSymbols[index];
+}
+
+std::string Loader::string(uint32_t index) {
+	return symbol(index);
+}
+
+Symbol Loader::id(const Record &r) {
+	return r.hasId() ? symbol(r.id()) : Symbol();
+}
+
+void Loader::setInfo(Record &r, std::shared_ptr<IRNode> node) {
+	if (!r.hasInfo())
+		return;
+
+	uint32_t index = r.info();
+	check(index < mStringCount, "Invalid string reference");
+	if (!mInfos[index])
+		mInfos[index] = make_node<Info>(string(index));
+
+	node->setInfo(mInfos[index]);
+}
+
+std::shared_ptr<Circuit> Loader::load() {
+	Record r = record(mRoot);
+	check(r.kind() == Format::CIRCUIT, "Root is not a circuit");
+
+	auto circuit = make_node<Circuit>(id(r));
+	setInfo(r, circuit);
+
+	for (uint32_t n = r.next(); n > 0; n--)
+		circuit->addModule(loadModule(r.child()));
+
+	return circuit;
+}
+
+std::shared_ptr<Module> Loader::loadModule(Record r) {
+	check(r.kind() == Format::MODULE, "Expected module");
+
+	auto mod = make_node<Module>(id(r),
+			r.flags() & Format::FLAG_EXTERNAL);
+	setInfo(r, mod);
+
+	uint32_t defname = r.next();
+	if (defname)
+		mod->setDefname(string(defname - 1));
+
+	for (uint32_t n = r.next(); n > 0; n--)
+		mod->addPort(loadPort(r.child()));
+
+	for (uint32_t n = r.next(); n > 0; n--) {
+		Record p = r.child();
+		check(p.kind() == Format::PARAMETER, "Expected parameter");
+		auto param = make_node<Parameter>();
+		setInfo(p, param);
+		mod->addParameter(param);
+	}
+
+	if (!r.hasChild())
+		return mod;
+
+	// The statements go to the same arena as the rest of the circuit
+	uint32_t body = r.childOffset();
+	Arena *current = Arena::current();
+	std::shared_ptr<Arena> arena;
+	if (current) {
+		current->acquire();
+		arena = std::shared_ptr<Arena>(current,
+				[] (Arena *a) { a->release(); });
+	}
+
+	std::shared_ptr<Loader> self = shared_from_this();
+	mod->setStatementLoader([self, arena, body] () {
+		ArenaScope scope(arena);
+		// The caches are shared by the modules
+		std::lock_guard<std::mutex> lock(self->mMutex);
+		return self->load<StmtGroup>(body);
+	});
+
+	return mod;
+}
+
+std::shared_ptr<Port> Loader::loadPort(Record r) {
+	check(r.kind() == Format::PORT, "Expected port");
+
+	Port::Direction dir = (r.flags() & Format::FLAG_OUTPUT) ?
+			Port::OUTPUT : Port::INPUT;
+	auto port = make_node<Port>(id(r), dir,
+			load<Type>(r.childOffset()));
+	setInfo(r, port);
+
+	return port;
+}
+
+template <typename T>
+std::shared_ptr<T> Loader::load(uint32_t offset) {
+	std::shared_ptr<IRNode> node = loadNode(offset);
+	check(isa<T>(node), "Unexpected node");
+	return std::static_pointer_cast<T>(node);
+}
+
+std::shared_ptr<IRNode> Loader::loadNode(uint32_t offset) {
+	// Every record is taken from the stack twice: first its children are
+	// pushed, then the node is created from the loaded children. Deep
+	// trees are loaded without recursion this way.
+	struct Pending {
+		uint32_t offset;
+		uint32_t children;
+		bool queued;
+	};
+	std::vector<Pending> pending;
+	pending.push_back({ offset, 0, false });
+	mLoaded.clear();
+
+	while (!pending.empty()) {
+		size_t top = pending.size() - 1;
+
+		if (!pending[top].queued) {
+			pending[top].queued = true;
+			Record r = record(pending[top].offset);
+			const char *fields = Format::layout(r.kind());
+			check(fields != nullptr, "Invalid node kind");
+
+			for (; *fields; fields++) {
+				bool list = (*fields == 'C') || (*fields == 'W');
+				bool child = (*fields == 'c') || (*fields == 'C');
+				for (uint32_t n = list ? r.next() : 1; n > 0; n--) {
+					if (child && r.hasChild())
+						pending.push_back({ r.childOffset(), 0, false });
+					else
+						r.next();
+				}
+			}
+
+			// The first child is loaded first
+			pending[top].children = pending.size() - top - 1;
+			std::reverse(pending.begin() + top + 1, pending.end());
+			continue;
+		}
+
+		Pending p = pending.back();
+		pending.pop_back();
+
+		Record r = record(p.offset);
+		mChild = mLoaded.size() - p.children;
+		std::shared_ptr<IRNode> node = create(r);
+		mLoaded.resize(mLoaded.size() - p.children);
+		mLoaded.push_back(node);
+	}
+
+	return mLoaded.back();
+}
+
+template <typename T>
+std::shared_ptr<T> Loader::child(Record &r) {
+	// The children were loaded in the order of their references
+	r.childOffset();
+	check(mChild < mLoaded.size(), "Invalid child reference");
+	std::shared_ptr<IRNode> &node = mLoaded[mChild++];
+	check(isa<T>(node), "Unexpected node");
+	return std::static_pointer_cast<T>(node);
+}
+
+std::shared_ptr<IRNode> Loader::create(Record &r) {
+	switch (r.kind()) {
+	case Format::TYPE_INT:
+	case Format::TYPE_CLOCK:
+	case Format::TYPE_BUNDLE:
+	case Format::TYPE_VECTOR:
+		return createType(r);
+	case Format::FIELD: {
+		auto field = make_node<Field>(id(r), child<Type>(r),
+				r.flags() & Format::FLAG_FLIP);
+		setInfo(r, field);
+		return field;
+	}
+	case Format::CONDITIONAL_ELSE: {
+		auto otherwise = make_node<ConditionalElse>();
+		setInfo(r, otherwise);
+		if (r.hasChild())
+			otherwise->setStmts(child<StmtGroup>(r));
+		return otherwise;
+	}
+	case Format::REFERENCE:
+	case Format::CONSTANT:
+	case Format::SUB_FIELD:
+	case Format::SUB_INDEX:
+	case Format::SUB_ACCESS:
+	case Format::MUX:
+	case Format::COND_VALID:
+	case Format::PRIMOP:
+		return createExp(r);
+	default:
+		return createStmt(r);
+	}
+}
+
+std::shared_ptr<Type> Loader::createType(Record &r) {
+	std::shared_ptr<Type> type;
+
+	switch (r.kind()) {
+	case Format::TYPE_INT:
+		type = make_node<TypeInt>(r.flags() & Format::FLAG_SIGNED,
+				(int) r.next());
+		break;
+	case Format::TYPE_CLOCK:
+		type = make_node<TypeClock>();
+		break;
+	case Format::TYPE_BUNDLE: {
+		auto bundle = make_node<TypeBundle>();
+		for (uint32_t n = r.next(); n > 0; n--)
+			bundle->addField(child<Field>(r));
+		type = bundle;
+		break;
+	}
+	case Format::TYPE_VECTOR: {
+		std::shared_ptr<Type> of = child<Type>(r);
+		type = make_node<TypeVector>(of, (int) r.next());
+		break;
+	}
+	default:
+		throw std::runtime_error("Expected type");
+	}
+
+	setInfo(r, type);
+	return type;
+}
+
+std::vector<std::string> Loader::loadStrings(Record &r) {
+	std::vector<std::string> list;
+
+	for (uint32_t n = r.next(); n > 0; n--)
+		list.push_back(string(r.next()));
+
+	return list;
+}
+
+std::shared_ptr<Stmt> Loader::createStmt(Record &r) {
+	std::shared_ptr<Stmt> stmt;
+
+	switch (r.kind()) {
+	case Format::STMT_GROUP: {
+		auto group = make_node<StmtGroup>();
+		for (uint32_t n = r.next(); n > 0; n--)
+			group->addStatement(child<Stmt>(r));
+		stmt = group;
+		break;
+	}
+	case Format::WIRE:
+		stmt = make_node<Wire>(id(r), child<Type>(r));
+		break;
+	case Format::REG: {
+		std::shared_ptr<Type> type = child<Type>(r);
+		auto reg = make_node<Reg>(id(r), type, child<Expression>(r));
+		if (r.hasChild())
+			reg->setResetTrigger(child<Expression>(r));
+		else
+			r.next();
+		if (r.hasChild())
+			reg->setResetValue(child<Expression>(r));
+		stmt = reg;
+		break;
+	}
+	case Format::MEMORY: {
+		auto mem = make_node<Memory>(id(r));
+		if (r.hasChild())
+			mem->setDType(child<Type>(r));
+		else
+			r.next();
+
+		int depth = r.next();
+		int readLatency = r.next();
+		int writeLatency = r.next();
+		if (depth >= 0)
+			mem->setDepth(depth);
+		if (readLatency >= 0)
+			mem->setReadLatency(readLatency);
+		if (writeLatency >= 0)
+			mem->setWriteLatency(writeLatency);
+		mem->setRuwFlag((Memory::RuwFlag) r.flags());
+
+		for (auto &s : loadStrings(r))
+			mem->addReader(s);
+		for (auto &s : loadStrings(r))
+			mem->addWriter(s);
+		for (auto &s : loadStrings(r))
+			mem->addReadWriter(s);
+		stmt = mem;
+		break;
+	}
+	case Format::INSTANCE:
+		stmt = make_node<Instance>(id(r),
+				make_node<Reference>(symbol(r.next())));
+		break;
+	case Format::NODE:
+		stmt = make_node<Node>(id(r), child<Expression>(r));
+		break;
+	case Format::CONNECT: {
+		std::shared_ptr<Expression> to = child<Expression>(r);
+		stmt = make_node<Connect>(to, child<Expression>(r),
+				r.flags() & Format::FLAG_PARTIAL);
+		break;
+	}
+	case Format::INVALID:
+		stmt = make_node<Invalid>(child<Expression>(r));
+		break;
+	case Format::CONDITIONAL: {
+		auto cond = make_node<Conditional>(child<Expression>(r));
+		if (r.hasChild())
+			cond->setThen(child<StmtGroup>(r));
+		else
+			r.next();
+		if (r.hasChild())
+			cond->setElse(child<ConditionalElse>(r));
+		stmt = cond;
+		break;
+	}
+	case Format::STOP: {
+		std::shared_ptr<Expression> clock = child<Expression>(r);
+		std::shared_ptr<Expression> cond = child<Expression>(r);
+		stmt = make_node<Stop>(clock, cond, (int) r.next());
+		break;
+	}
+	case Format::PRINTF: {
+		std::shared_ptr<Expression> clock = child<Expression>(r);
+		std::shared_ptr<Expression> cond = child<Expression>(r);
+		auto print = make_node<Printf>(clock, cond, string(r.next()));
+		for (uint32_t n = r.next(); n > 0; n--)
+			print->addArgument(child<Expression>(r));
+		stmt = print;
+		break;
+	}
+	case Format::EMPTY:
+		stmt = make_node<Empty>();
+		break;
+	default:
+		throw std::runtime_error("Expected statement");
+	}
+
+	setInfo(r, stmt);
+	return stmt;
+}
+
+std::shared_ptr<Expression> Loader::createExp(Record &r) {
+	std::shared_ptr<Expression> exp;
+
+	switch (r.kind()) {
+	case Format::REFERENCE:
+		exp = make_node<Reference>(symbol(r.next()));
+		break;
+	case Format::CONSTANT: {
+		std::shared_ptr<TypeInt> type = child<TypeInt>(r);
+		exp = make_node<Constant>(type, symbol(r.next()),
+				(Constant::GenerateHint) r.flags());
+		break;
+	}
+	case Format::SUB_FIELD: {
+		std::shared_ptr<Expression> of = child<Expression>(r);
+		exp = make_node<SubField>(make_node<Reference>(symbol(r.next())), of);
+		break;
+	}
+	case Format::SUB_INDEX: {
+		std::shared_ptr<Expression> of = child<Expression>(r);
+		exp = make_node<SubIndex>((int) r.next(), of);
+		break;
+	}
+	case Format::SUB_ACCESS: {
+		std::shared_ptr<Expression> of = child<Expression>(r);
+		exp = make_node<SubAccess>(child<Expression>(r), of);
+		break;
+	}
+	case Format::MUX: {
+		std::shared_ptr<Expression> sel = child<Expression>(r);
+		std::shared_ptr<Expression> a = child<Expression>(r);
+		exp = make_node<Mux>(sel, a, child<Expression>(r));
+		break;
+	}
+	case Format::COND_VALID: {
+		std::shared_ptr<Expression> sel = child<Expression>(r);
+		exp = make_node<CondValid>(sel, child<Expression>(r));
+		break;
+	}
+	case Format::PRIMOP: {
+		check(r.flags() < PrimOp::UNDEFINED, "Invalid operation");
+		auto op = PrimOp::generate((PrimOp::Operation) r.flags());
+		for (uint32_t n = r.next(); n > 0; n--)
+			op->addOperand(child<Expression>(r));
+		for (uint32_t n = r.next(); n > 0; n--)
+			op->addParameter(r.next());
+		exp = op;
+		break;
+	}
+	default:
+		throw std::runtime_error("Expected expression");
+	}
+
+	setInfo(r, exp);
+	return exp;
+}
+
+bool Frontend::parseString(const char *begin, const char *end) {
+	try {
+		auto loader = std::make_shared<Loader>(begin, end, mInputOwner);
+		mIR = loader->load();
+	} catch (std::runtime_error &e) {
+		std::cerr << "Invalid FIRB image: " << e.what() << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+}
+}
+}
@@ -30,11 +30,13 @@ namespace Firrtl {
 
 class Frontend : public ::Firrtlator::Frontend::FrontendBase {
 public:
-	virtual bool parseString(std::string::const_iterator begin,
-			std::string::const_iterator end);
+	virtual bool parseString(const char *begin, const char *end);
 	static std::string name;
 	static std::string description;
 	static std::vector<std::string> filetypes;
+private:
+	bool parseParallel(const char *begin, const char *end,
+			const std::vector<const char*> &modules);
 };
 
 }
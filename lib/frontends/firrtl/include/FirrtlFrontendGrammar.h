@@ -23,10 +23,13 @@
 //#define BOOST_SPIRIT_DEBUG 1
 
 #include "FirrtlFrontendLexer.h"
+#include "FirrtlatorFrontend.h"
 
 #include <boost/spirit/include/qi.hpp>
 #include <boost/spirit/include/phoenix.hpp>
 
+#include <cstdlib>
+
 namespace Firrtlator {
 namespace Frontend {
 namespace Firrtl {
@@ -43,7 +46,7 @@ struct make_shared_f
 
     template <typename... A>
     typename result<A...>::type operator()(A&&... a) const {
-        return std::make_shared<T>(std::forward<A>(a)...);
+        return make_node<T>(std::forward<A>(a)...);
     }
 };
 
@@ -54,13 +57,35 @@ struct gen_primop_f
 {
     struct result { typedef std::shared_ptr<PrimOp> type; };
 
-    typename result::type operator()(std::string &op) const {
+    typename result::type operator()(PrimOp::Operation op) const {
         return PrimOp::generate(op);
     }
 };
 
 using gen_primop = phoenix::function<gen_primop_f >;
 
+struct to_int_f
+{
+    struct result { typedef int type; };
+
+    typename result::type operator()(const std::string &value) const {
+        return std::strtol(value.c_str(), nullptr, 10);
+    }
+};
+
+using to_int = phoenix::function<to_int_f >;
+
+struct get_info_f
+{
+    struct result { typedef std::shared_ptr<Info> type; };
+
+    typename result::type operator()(InfoCache &cache, std::string &value) const {
+        return cache.get(value);
+    }
+};
+
+using get_info = phoenix::function<get_info_f >;
+
 template <typename Iterator>
 struct FirrtlGrammar : qi::grammar<Iterator, std::shared_ptr<Circuit>()>
 {
@@ -83,6 +108,11 @@ struct FirrtlGrammar : qi::grammar<Iterator, std::shared_ptr<Circuit>()>
 
 		using boost::spirit::eps;
 
+		// Constants keep the text of the literal, which may not fit an int
+		int_ = tok.int_ [_val = to_int()(_1)]
+				;
+		BOOST_SPIRIT_DEBUG_NODE(int_);
+
 		circuit = tok.circuit
 			>> tok.identifier [_val = make_shared<Circuit>()(_1)]
 			>> ":"
@@ -93,7 +123,7 @@ struct FirrtlGrammar : qi::grammar<Iterator, std::shared_ptr<Circuit>()>
 			;
 		BOOST_SPIRIT_DEBUG_NODE(circuit);
 
-		info = tok.info[_val = make_shared<Info>()(_1)]
+		info = tok.info[_val = get_info()(phoenix::ref(infos), _1)]
 			;
 		BOOST_SPIRIT_DEBUG_NODE(info);
 
@@ -158,7 +188,7 @@ struct FirrtlGrammar : qi::grammar<Iterator, std::shared_ptr<Circuit>()>
 
 		type_int = (tok.UInt [_val = make_shared<TypeInt>()(false)]
 			        | tok.SInt [_val = make_shared<TypeInt>()(true)])
-				>> -("<" >> tok.int_ [bind(&TypeInt::setWidth, _val, _1)] >> ">")
+				>> -("<" >> int_ [bind(&TypeInt::setWidth, _val, _1)] >> ">")
 				;
 		BOOST_SPIRIT_DEBUG_NODE(type_int);
 
@@ -170,7 +200,7 @@ struct FirrtlGrammar : qi::grammar<Iterator, std::shared_ptr<Circuit>()>
 
 		type_vector = type [_val = make_shared<TypeVector>()()]
 				>> "["
-				>> tok.int_ [bind(&TypeVector::setSize, _val, _1)]
+				>> int_ [bind(&TypeVector::setSize, _val, _1)]
 				>> "]"
 				;
 		BOOST_SPIRIT_DEBUG_NODE(type_vector);
@@ -183,8 +213,8 @@ struct FirrtlGrammar : qi::grammar<Iterator, std::shared_ptr<Circuit>()>
 				;
 		BOOST_SPIRIT_DEBUG_NODE(field);
 
-		stmt %= wire | reg | mem | inst | node | connect | partconnect
-				| invalidate | conditional | stop | printf_ | empty
+		stmt %= wire | reg | mem | inst | node | exp_stmt
+				| conditional | stop | printf_ | empty
 				;
 		BOOST_SPIRIT_DEBUG_NODE(stmt);
 
@@ -238,17 +268,17 @@ struct FirrtlGrammar : qi::grammar<Iterator, std::shared_ptr<Circuit>()>
 		BOOST_SPIRIT_DEBUG_NODE(mem_dtype);
 
 		mem_depth = tok.depth >> tok.assign
-				>> tok.int_ [bind(&Memory::setDepth, _r1, _1)]
+				>> int_ [bind(&Memory::setDepth, _r1, _1)]
 				;
 		BOOST_SPIRIT_DEBUG_NODE(mem_depth);
 
 		mem_readlat = tok.readlat >> tok.assign
-				>> tok.int_ [bind(&Memory::setReadLatency, _r1, _1)]
+				>> int_ [bind(&Memory::setReadLatency, _r1, _1)]
 				;
 		BOOST_SPIRIT_DEBUG_NODE(mem_readlat);
 
 		mem_writelat = tok.writelat >> tok.assign
-				>> tok.int_ [bind(&Memory::setWriteLatency, _r1, _1)]
+				>> int_ [bind(&Memory::setWriteLatency, _r1, _1)]
 				;
 		BOOST_SPIRIT_DEBUG_NODE(mem_writelat);
 
@@ -291,25 +321,19 @@ struct FirrtlGrammar : qi::grammar<Iterator, std::shared_ptr<Circuit>()>
 				;
 		BOOST_SPIRIT_DEBUG_NODE(node);
 
-		connect = (exp_
-				>> tok.connect
-				>> exp_) [_val = make_shared<Connect>()(_1, _3)]
-				>> -info [bind(&Connect::setInfo, _val, _1)]
-				;
-		BOOST_SPIRIT_DEBUG_NODE(connect);
-
-		partconnect = (exp_
-				>> tok.partconnect
-				>> exp_) [_val = make_shared<Connect>()(_1, _3, true)]
-				>> -info [bind(&Connect::setInfo, _val, _1)]
-				;
-		BOOST_SPIRIT_DEBUG_NODE(partconnect);
-
-		invalidate = exp_ [_val = make_shared<Invalid>()(_1)]
-				>> tok.is >> tok.invalid
-				>> -info [bind(&Invalid::setInfo, _val, _1)]
+		// Connections and invalidations start with an expression, which is
+		// only parsed once. The token after it decides the statement.
+		exp_stmt = exp_ [_a = _1]
+				>> (tok.connect
+				    >> exp_ [_val = make_shared<Connect>()(_a, _1)]
+				   | tok.partconnect
+				    >> exp_ [_val = make_shared<Connect>()(_a, _1, true)]
+				   | tok.is
+				    >> tok.invalid [_val = make_shared<Invalid>()(_a)]
+				   )
+				>> -info [bind(&Stmt::setInfo, _val, _1)]
 				;
-		BOOST_SPIRIT_DEBUG_NODE(invalidate);
+		BOOST_SPIRIT_DEBUG_NODE(exp_stmt);
 
 		conditional = tok.when
 				>> exp_ [_val = make_shared<Conditional>()(_1)]
@@ -318,7 +342,7 @@ struct FirrtlGrammar : qi::grammar<Iterator, std::shared_ptr<Circuit>()>
 				>> -(stmt_group [bind(&Conditional::setThen, _val, _1)]
 					| stmt_suite [bind(&Conditional::setThen, _val, _1)]
 					)
-				>> -conditional_else
+				>> -conditional_else [bind(&Conditional::setElse, _val, _1)]
 				;
 		BOOST_SPIRIT_DEBUG_NODE(conditional);
 
@@ -337,7 +361,7 @@ struct FirrtlGrammar : qi::grammar<Iterator, std::shared_ptr<Circuit>()>
 		stop = tok.stop
 				>> "("
 				>> (exp_ >> exp_ >>
-						tok.int_) [_val = make_shared<Stop>()(_1, _2, _3)]
+						int_) [_val = make_shared<Stop>()(_1, _2, _3)]
 				>> ")"
 				>> -info [bind(&Stop::setInfo, _val, _1)]
 				;
@@ -347,7 +371,7 @@ struct FirrtlGrammar : qi::grammar<Iterator, std::shared_ptr<Circuit>()>
 				>> "("
 				>> (exp_ >> exp_
 				>> tok.string_double) [_val = make_shared<Printf>()(_1, _2, _3)]
-				>> *exp_ /*[bind(&Printf::addArgument, _val, _1)]*/
+				>> *exp_ [bind(&Printf::addArgument, _val, _1)]
 				>> ")"
 				>> -info [bind(&Printf::setInfo, _val, _1)]
 				;
@@ -377,7 +401,8 @@ struct FirrtlGrammar : qi::grammar<Iterator, std::shared_ptr<Circuit>()>
 
 		exp_int = type_int [_a = _1]
 				>> "("
-				>> ( tok.int_ [_val = make_shared<Constant>()(_a, _1)]
+				>> ( tok.int_ [_val = make_shared<Constant>()(_a, _1,
+						Constant::INT)]
 					| tok.string_double [_val = make_shared<Constant>()(_a, _1)]
 				   ) >> ")"
 				;
@@ -389,7 +414,7 @@ struct FirrtlGrammar : qi::grammar<Iterator, std::shared_ptr<Circuit>()>
 				;
 		BOOST_SPIRIT_DEBUG_NODE(exp_subfield);
 
-		exp_subindex = "[" >> tok.int_ [_a = make_shared<SubIndex>()(_1, _r1)]
+		exp_subindex = "[" >> int_ [_a = make_shared<SubIndex>()(_1, _r1)]
 				>> "]" >> exp_helper(_a) [_val = _1]
 				;
 		BOOST_SPIRIT_DEBUG_NODE(exp_subindex);
@@ -414,14 +439,17 @@ struct FirrtlGrammar : qi::grammar<Iterator, std::shared_ptr<Circuit>()>
 
 		primop = tok.primop [_val = gen_primop()(_1)]
 				>> *exp_ [bind(&PrimOp::addOperand, _val, _1)]
-				>> *tok.int_ [bind(&PrimOp::addParameter, _val, _1)]
+				>> *int_ [bind(&PrimOp::addParameter, _val, _1)]
 				>> ")"
 				;
 		BOOST_SPIRIT_DEBUG_NODE(primop);
 
 	}
 
+	InfoCache infos;
+
 	qi::rule<Iterator, std::shared_ptr<Circuit>()> circuit;
+	qi::rule<Iterator, int()> int_;
 	qi::rule<Iterator, std::shared_ptr<Info>()> info;
     qi::rule<Iterator, std::shared_ptr<Module>()> module, extmodule, intmodule;
     qi::rule<Iterator, std::shared_ptr<Port>(), qi::locals<Port::Direction>> port;
@@ -439,8 +467,8 @@ struct FirrtlGrammar : qi::grammar<Iterator, std::shared_ptr<Circuit>()>
     qi::rule<Iterator, std::shared_ptr<Memory>()> mem;
     qi::rule<Iterator, std::shared_ptr<Instance>() > inst;
     qi::rule<Iterator, std::shared_ptr<Node>()> node;
-    qi::rule<Iterator, std::shared_ptr<Connect>()> connect, partconnect;
-    qi::rule<Iterator, std::shared_ptr<Invalid>()> invalidate;
+    qi::rule<Iterator, std::shared_ptr<Stmt>(),
+    		qi::locals<std::shared_ptr<Expression> > > exp_stmt;
     qi::rule<Iterator, std::shared_ptr<Stop>()> stop;
     qi::rule<Iterator, std::shared_ptr<Printf>()> printf_;
     qi::rule<Iterator, std::shared_ptr<Empty>()> empty;
@@ -474,6 +502,22 @@ struct FirrtlGrammar : qi::grammar<Iterator, std::shared_ptr<Circuit>()>
     qi::rule<Iterator, std::shared_ptr<PrimOp>()> primop;
 };
 
+// Parses a single module, used to parse the modules of a circuit in
+// parallel
+template <typename Iterator>
+struct FirrtlModuleGrammar : qi::grammar<Iterator, std::shared_ptr<Module>()>
+{
+	template< typename TokenDef >
+	FirrtlModuleGrammar(const TokenDef& tok)
+	: FirrtlModuleGrammar::base_type(start), g(tok)
+	{
+		start %= g.module;
+	}
+
+	FirrtlGrammar<Iterator> g;
+	qi::rule<Iterator, std::shared_ptr<Module>()> start;
+};
+
 }
 }
 }
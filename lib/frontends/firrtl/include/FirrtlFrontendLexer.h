@@ -50,7 +50,7 @@ public:
 , newline_("[\\n\\r\\f]+")
 , whitespace_("[ \\t,]+")
 , emptyline("[ \\t]*$")
-, comment_ (";.*$")
+, comment_ (";[^\\n]*")
 , identifier("[A-Za-z_][A-Za-z0-9_]*")
 , info ("@\\[[^\\]]*\\]")
 #define TERM(x) x(#x)
@@ -100,7 +100,7 @@ public:
 , connect("<=")
 , partconnect("<-")
 , assign("=>")
-, primop("(add|sub|mul|div|mod|lt|leq|gt|geq|eq|neq|pad|asUInt|asSint|"
+, primop("(add|sub|mul|div|mod|lt|leq|gt|geq|eq|neq|pad|asUInt|asSInt|"
 		"asClock|shl|shr|dshl|dshr|cvt|neg|not|and|or|xor|andr|orr|"
 		"xorr|cat|bits|head|tail)\\(")
 
@@ -138,6 +138,14 @@ public:
 				| whitespace_[lex::_pass=lex::pass_flags::pass_ignore]
 				;
 }
+
+	// Lex a fragment of a file that starts at the given indentation
+	void setBaseIndentation(int level) {
+		while (!scopeLevels_.empty())
+			scopeLevels_.pop();
+		scopeLevels_.push(level);
+	}
+
 	lex::token_def<> indent_;
 	lex::token_def<lex::omit> newline_, whitespace_, emptyline;
 	lex::token_def<> comment_;
@@ -155,9 +163,9 @@ public:
 
 	lex::token_def<> connect, partconnect, assign;
 
-	lex::token_def<std::string> primop;
+	lex::token_def<PrimOp::Operation> primop;
 
-	lex::token_def<int> int_;
+	lex::token_def<std::string> int_;
 	lex::token_def<> double_;
 	lex::token_def<std::string> string_double, string_single;
 
@@ -20,9 +20,14 @@
  * SOFTWARE.
  */#pragma once
 
+#include "IR.h"
+#include "FirrtlatorKeywords.h"
+
 #include <boost/spirit/include/lex.hpp>
 #include <boost/spirit/include/lex_lexertl.hpp>
 
+#include <stack>
+
 namespace Firrtlator {
 namespace Frontend {
 namespace Firrtl {
@@ -99,10 +104,10 @@ public:
 
 		if (context.get_eoi() == end) {
 			// If the "end of input" is reached
-			// we pop up all the non-zero levels.
+			// we pop up all the levels above the base level.
 			// for each pop up we generate a corresponding END token
 			// here we apply the zero-match trick again to emit multiple END token
-			while (scopeLevels_.top() != 0) {
+			while (scopeLevels_.size() > 1) {
 				scopeLevels_.pop();
 				end = start;
 				id = DEDENT;
@@ -230,10 +235,10 @@ public:
 			Iterator& end,
 			BOOST_SCOPED_ENUM(lex::pass_flags)& passFlag,
 			IdType& id, Context& context) {
-		std::string raw(start,end-1);
-		PrimOp::Operation op;
-		if (PrimOp::lookup(raw, op)) {
-			context.set_value(raw);
+		// The token includes the opening parenthesis
+		const Keywords::Entry *e = Keywords::lookup(&*start, end - start - 1);
+		if (e && (e->keyword == Keywords::PRIMOP)) {
+			context.set_value(e->op);
 		} else {
 			passFlag = lex::pass_flags::pass_fail;
 		}
@@ -243,3 +248,21 @@ public:
 }
 }
 }
+
+namespace boost {
+namespace spirit {
+namespace traits {
+
+// Converts the matched text if the token value was not set by HandlePrimOp
+template <typename Iterator>
+struct assign_to_attribute_from_iterators<Firrtlator::PrimOp::Operation,
+	Iterator> {
+	static void call(Iterator const& first, Iterator const& last,
+			Firrtlator::PrimOp::Operation& attr) {
+		Firrtlator::PrimOp::lookup(std::string(first, last - 1), attr);
+	}
+};
+
+}
+}
+}
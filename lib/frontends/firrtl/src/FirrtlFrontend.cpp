@@ -25,8 +25,25 @@
 #include "FirrtlFrontendLexer.h"
 #include "FirrtlFrontendGrammar.h"
 
+// Lexer DFA generated at build time by firrtl-lexer-generator. GCC
+// reports a bogus uninitialized use in the Boost static lexer data.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <boost/spirit/include/lex_static_lexertl.hpp>
+#pragma GCC diagnostic pop
+#include "FirrtlFrontendLexerStatic.h"
+
+#include "FirrtlatorScanner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
 #include <iostream>
 
+#include <pthread.h>
+
 namespace Firrtlator {
 namespace Frontend {
 namespace Firrtl {
@@ -37,28 +54,139 @@ std::vector<std::string> Frontend::filetypes = { "fir" };
 
 REGISTER_FRONTEND(Frontend)
 
-bool Frontend::parseString(std::string::const_iterator begin,
-        std::string::const_iterator end) {
+typedef lex::lexertl::token<const char*,
+		boost::mpl::vector<std::string, int,
+			PrimOp::Operation> > token_type;
+typedef lex::lexertl::static_actor_lexer<token_type,
+		lex::lexertl::static_::lexer_firrtl> lexer_type;
+typedef Tokens<lexer_type>::iterator_type iterator_type;
+
+// The rules of the grammar recurse for every nested construct, so the
+// stack grows with the nesting depth. Nested expressions take up to 100
+// bytes of stack per byte of input.
+static const size_t stackPerByte = 128;
+// Inputs that need less are parsed on the calling thread
+static const size_t callerStack = 1 << 20;
+static const size_t maxStack = (size_t) 1 << 30;
+
+static void *runParser(void *parser) {
+	(*static_cast<std::function<void()>*>(parser))();
+	return nullptr;
+}
+
+// Runs the parser on count threads whose stack fits an input of the given
+// size, which std::thread cannot set. The calling thread is one of them
+// if its stack suffices or no thread can be created.
+static void runParsers(unsigned count, size_t size,
+		std::function<void()> parser) {
+	size_t stack = std::min(size * stackPerByte, maxStack);
+	bool caller = (stack <= callerStack);
+
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	if (!caller)
+		pthread_attr_setstacksize(&attr, stack);
+
+	std::vector<pthread_t> threads;
+	for (unsigned t = caller ? 1 : 0; t < count; t++) {
+		pthread_t thread;
+		if (pthread_create(&thread, &attr, runParser, &parser) == 0)
+			threads.push_back(thread);
+	}
+	pthread_attr_destroy(&attr);
+
+	if (caller || threads.empty())
+		parser();
+	for (auto &t : threads)
+		pthread_join(t, nullptr);
+}
 
-		typedef lex::lexertl::token<std::string::const_iterator,
-				boost::mpl::vector<std::string, int> > token_type;
-		typedef lex::lexertl::actor_lexer<token_type> lexer_type;
-		typedef Tokens<lexer_type>::iterator_type iterator_type;
+bool Frontend::parseString(const char *begin, const char *end) {
+	std::vector<const char*> modules;
 
-		Tokens<lexer_type> token_lexer;
+	if (mThreads > 1)
+		modules = Scanner::findModules(begin, end);
 
-		lexer_type::iterator_type first = token_lexer.begin(begin, end);
-		lexer_type::iterator_type last = token_lexer.end();
+	if (modules.size() > 1)
+		return parseParallel(begin, end, modules);
 
-		FirrtlGrammar<iterator_type> g(token_lexer);
+	bool res = false;
+	std::exception_ptr error;
+	// The nodes go to the arena of the caller
+	Arena *arena = Arena::current();
 
-		bool res = lex::tokenize_and_parse(begin, end, token_lexer, g, mIR);
+	runParsers(1, end - begin, [&] () {
+		Arena::setCurrent(arena);
+		try {
+			Tokens<lexer_type> token_lexer;
+			FirrtlGrammar<iterator_type> g(token_lexer);
 
-		if (begin != end)
-			res = false;
+			res = lex::tokenize_and_parse(begin, end, token_lexer, g, mIR)
+					&& (begin == end);
+		} catch (...) {
+			error = std::current_exception();
+		}
+	});
 
-	if (!res) {
+	if (error)
+		std::rethrow_exception(error);
+
+	return res;
+}
+
+bool Frontend::parseParallel(const char *begin, const char *end,
+		const std::vector<const char*> &starts) {
+	// The circuit header is everything before the first module
+	const char *header = begin;
+	const char *headerEnd = starts[0];
+	Tokens<lexer_type> token_lexer;
+	FirrtlGrammar<iterator_type> g(token_lexer);
+
+	if (!lex::tokenize_and_parse(header, headerEnd, token_lexer, g, mIR)
+			|| (header != headerEnd))
 		return false;
+
+	std::vector<std::shared_ptr<Module> > modules(starts.size());
+	// Not vector<bool>, which packs the flags of different threads into a word
+	std::vector<char> success(starts.size(), false);
+	std::vector<std::exception_ptr> errors(starts.size());
+	std::atomic<size_t> next(0);
+
+	// Each worker has its own lexer and grammar and picks the next
+	// unparsed module until all are done
+	auto worker = [&] () {
+		ArenaScope scope(Arena::create());
+		Tokens<lexer_type> module_lexer;
+		FirrtlModuleGrammar<iterator_type> mg(module_lexer);
+
+		for (size_t i = next++; i < starts.size(); i = next++) {
+			const char *first = starts[i];
+			const char *last = (i + 1 < starts.size()) ? starts[i + 1] : end;
+
+			try {
+				module_lexer.setBaseIndentation(
+						Scanner::skipBlanks(first, last) - first);
+				success[i] = lex::tokenize_and_parse(first, last,
+						module_lexer, mg, modules[i]) && (first == last);
+			} catch (...) {
+				errors[i] = std::current_exception();
+			}
+		}
+	};
+
+	// The stack has to fit the largest module
+	size_t largest = end - starts.back();
+	for (size_t i = 1; i < starts.size(); i++)
+		largest = std::max<size_t>(largest, starts[i] - starts[i - 1]);
+
+	runParsers(std::min<size_t>(mThreads, starts.size()), largest, worker);
+
+	for (size_t i = 0; i < starts.size(); i++) {
+		if (errors[i])
+			std::rethrow_exception(errors[i]);
+		if (!success[i])
+			return false;
+		mIR->addModule(modules[i]);
 	}
 
 	return true;
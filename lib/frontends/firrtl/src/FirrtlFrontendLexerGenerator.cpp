@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+ * Build time helper that generates the DFA of the FIRRTL lexer (Tokens) as
+ * C++ source. The FIRRTL frontend is compiled against the generated code
+ * and uses the static lexer, so that the regular expressions are not
+ * compiled to a DFA on every parse.
+ *
+ * The DFA is emitted as switch-based code. The table-based generator of
+ * Boost emits code that does not compile for lexers that use the end of
+ * line assertion ('$') without the begin of line assertion, as we do.
+ * The switch-based generator in turn fails on "any character" transitions
+ * next to an end of line assertion, hence comments are matched as
+ * ";[^\n]*" instead of ";.*$" (which is equivalent).
+ */
+
+#include "FirrtlFrontendLexer.h"
+
+#include <boost/spirit/include/lex_generate_static_lexertl.hpp>
+
+#include <fstream>
+#include <iostream>
+
+using namespace Firrtlator::Frontend::Firrtl;
+
+int main(int argc, char* argv[]) {
+	typedef lex::lexertl::token<const char*,
+			boost::mpl::vector<std::string, int,
+			Firrtlator::PrimOp::Operation> > token_type;
+	typedef lex::lexertl::actor_lexer<token_type> lexer_type;
+
+	if (argc != 2) {
+		std::cerr << "Usage: " << argv[0] << " <output>" << std::endl;
+		return 1;
+	}
+
+	std::ofstream out(argv[1]);
+	if (!out) {
+		std::cerr << "Cannot open " << argv[1] << std::endl;
+		return 1;
+	}
+
+	Tokens<lexer_type> token_lexer;
+
+	if (!lex::lexertl::generate_static_switch(token_lexer, out, "firrtl"))
+		return 1;
+
+	return 0;
+}
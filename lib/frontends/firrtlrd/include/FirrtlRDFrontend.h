@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "FirrtlatorFrontend.h"
+
+namespace Firrtlator {
+namespace Frontend {
+namespace FirrtlRD {
+
+class Frontend : public ::Firrtlator::Frontend::FrontendBase {
+public:
+	virtual bool parseString(const char *begin, const char *end);
+	static std::string name;
+	static std::string description;
+	static std::vector<std::string> filetypes;
+};
+
+/*
+ * Parses the module headers and ports only. The statements of a module
+ * are parsed when they are accessed first.
+ */
+class LazyFrontend : public ::Firrtlator::Frontend::FrontendBase {
+public:
+	virtual bool parseString(const char *begin, const char *end);
+	static std::string name;
+	static std::string description;
+	static std::vector<std::string> filetypes;
+};
+
+}
+}
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "Symbol.h"
+#include "FirrtlatorKeywords.h"
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+namespace Firrtlator {
+namespace Frontend {
+namespace FirrtlRD {
+
+class ParseError : public std::runtime_error {
+public:
+	ParseError(int line, std::string msg);
+	int getLine() { return mLine; }
+private:
+	int mLine;
+};
+
+struct Token {
+	typedef enum {
+		IDENTIFIER, INT, DOUBLE, STRING_DOUBLE, STRING_SINGLE, INFO,
+		COLON, LT, GT, LPAREN, RPAREN, EQUAL, LBRACE, RBRACE, DOT,
+		LBRACKET, RBRACKET, CONNECT, PARTCONNECT, ASSIGN,
+		INDENT, DEDENT, END
+	} Kind;
+
+	Kind kind;
+	const char *begin;
+	const char *end;
+	int line;
+	// Set for identifiers that spell a keyword or a primitive operation
+	Keywords::Keyword keyword;
+	PrimOp::Operation op;
+
+	std::string text() const { return std::string(begin, end); }
+	Symbol symbol() const { return Symbol(begin, end); }
+	bool is(Keywords::Keyword k) const { return keyword == k; }
+};
+
+/*
+ * Hand-written tokenizer for FIRRTL. It works on the raw input range,
+ * tokens reference the input by pointers. Like the Spirit lexer it
+ * generates INDENT and DEDENT tokens from the indentation of the lines and
+ * ignores whitespace, commas, comments and newlines otherwise. Keywords are
+ * returned as identifiers, which carry the keyword or primitive operation
+ * they spell.
+ */
+class Lexer {
+public:
+	// Lines are counted from line, for inputs that start within a file
+	Lexer(const char *begin, const char *end, int line = 1);
+
+	const Token &peek() { return mToken; }
+	Token next();
+
+	// Start of the line that contains the current token
+	const char *lineStart();
+
+	static const char *kindName(Token::Kind kind);
+private:
+	const char *mBegin;
+	const char *mCur;
+	const char *mEnd;
+	int mLine;
+	bool mLineStart;
+	int mParens;
+	std::vector<int> mLevels;
+	int mPendingDedents;
+	Token mToken;
+
+	void lex();
+	bool handleLineStart();
+	void skipWhitespace();
+	void make(Token::Kind kind, const char *begin, const char *end);
+	void lexNumber();
+	void lexString(char quote, Token::Kind kind);
+};
+
+}
+}
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "FirrtlRDFrontendLexer.h"
+
+#include "IR.h"
+#include "FirrtlatorFrontend.h"
+
+namespace Firrtlator {
+namespace Frontend {
+namespace FirrtlRD {
+
+/*
+ * Recursive-descent parser for FIRRTL. Every construct is decided by the
+ * next token, so the input is read exactly once and no node is built
+ * speculatively. It generates the same IR as the Spirit grammar.
+ */
+class Parser {
+public:
+	Parser(const char *begin, const char *end, int line = 1);
+
+	std::shared_ptr<Circuit> parseCircuit();
+
+	// Parse a module up to its statements. Returns with body set if the
+	// statements follow, those start at the line of bodyStart().
+	std::shared_ptr<Module> parseModuleHeader(bool &body);
+	const char *bodyStart();
+	// Parse the statements of a module body until the end of input
+	std::shared_ptr<StmtGroup> parseStmtFragment();
+private:
+	Lexer mLexer;
+	InfoCache mInfos;
+
+	// An expression whose operands are being parsed
+	struct OpenExp {
+		enum Kind { MUX, VALIDIF, PRIMOP, ACCESS } kind;
+		// The primitive operation, or what is accessed
+		std::shared_ptr<Expression> exp;
+		// Position of the first operand of a mux or validif in mOperands
+		size_t operands;
+	};
+	std::vector<OpenExp> mOpenExps;
+	std::vector<std::shared_ptr<Expression> > mOperands;
+
+	Token expect(Token::Kind kind);
+	void expectKeyword(Keywords::Keyword keyword);
+	bool accept(Token::Kind kind);
+	bool acceptKeyword(Keywords::Keyword keyword);
+	[[noreturn]] void error(std::string expected);
+
+	Symbol parseIdentifier();
+	int parseInt();
+	std::shared_ptr<Info> parseInfo();
+
+	std::shared_ptr<Module> parseModule();
+	std::shared_ptr<Port> parsePort();
+	std::shared_ptr<Parameter> parseParameter();
+
+	std::shared_ptr<Type> parseType();
+	std::shared_ptr<TypeInt> parseTypeInt();
+	std::shared_ptr<TypeBundle> parseTypeBundle();
+	std::shared_ptr<Field> parseField();
+
+	bool atStmt();
+	std::shared_ptr<StmtGroup> parseStmtGroup();
+	std::shared_ptr<StmtGroup> parseStmtBlock(int line);
+	std::shared_ptr<Stmt> parseStmt();
+	std::shared_ptr<Stmt> parseWire();
+	std::shared_ptr<Stmt> parseReg();
+	std::shared_ptr<Stmt> parseMem();
+	void parseMemField(std::shared_ptr<Memory> mem);
+	std::shared_ptr<Stmt> parseInst();
+	std::shared_ptr<Stmt> parseNode();
+	std::shared_ptr<Conditional> parseConditional();
+	std::shared_ptr<Stmt> parseStop();
+	std::shared_ptr<Stmt> parsePrintf();
+	std::shared_ptr<Stmt> parseEmpty();
+	std::shared_ptr<Stmt> parseExpStmt();
+
+	std::shared_ptr<Expression> parseExp();
+	std::shared_ptr<Expression> parseOperand();
+	std::shared_ptr<Expression> parseExpSuffix(std::shared_ptr<Expression> e);
+	std::shared_ptr<Expression> addOperand(std::shared_ptr<Expression> exp);
+	std::shared_ptr<Constant> parseConstant(std::shared_ptr<TypeInt> type);
+};
+
+}
+}
+}
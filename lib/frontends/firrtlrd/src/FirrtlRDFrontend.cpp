@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "FirrtlRDFrontend.h"
+#include "FirrtlRDFrontendParser.h"
+#include "FirrtlatorScanner.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace Firrtlator {
+namespace Frontend {
+namespace FirrtlRD {
+
+std::string Frontend::name = "FIRRTL-RD";
+std::string Frontend::description = "Reads FIRRTL files with a "
+		"hand-written recursive-descent parser";
+std::vector<std::string> Frontend::filetypes = { };
+
+REGISTER_FRONTEND(Frontend)
+
+std::string LazyFrontend::name = "FIRRTL-LAZY";
+std::string LazyFrontend::description = "Reads FIRRTL files, parses the "
+		"module statements on demand";
+std::vector<std::string> LazyFrontend::filetypes = { };
+
+REGISTER_FRONTEND(LazyFrontend)
+
+bool Frontend::parseString(const char *begin, const char *end) {
+	try {
+		Parser parser(begin, end);
+		mIR = parser.parseCircuit();
+	} catch (ParseError &e) {
+		std::cerr << "Parse error: " << e.what() << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool LazyFrontend::parseString(const char *begin, const char *end) {
+	std::shared_ptr<const void> owner = mInputOwner;
+
+	if (!owner) {
+		// Nobody keeps the input alive for the loaders, take a copy
+		auto copy = std::make_shared<std::string>(begin, end);
+		begin = copy->data();
+		end = begin + copy->size();
+		owner = copy;
+	}
+
+	std::vector<const char*> modules = Scanner::findModules(begin, end);
+
+	// The statements go to the same arena as the rest of the circuit
+	Arena *current = Arena::current();
+	std::shared_ptr<Arena> arena;
+	if (current) {
+		current->acquire();
+		arena = std::shared_ptr<Arena>(current,
+				[] (Arena *a) { a->release(); });
+	}
+
+	try {
+		Parser parser(begin, modules.empty() ? end : modules[0]);
+		mIR = parser.parseCircuit();
+
+		// Line of the current module in the file, for the error messages
+		const char *lineAt = begin;
+		int line = 1;
+
+		for (size_t i = 0; i < modules.size(); i++) {
+			const char *last = (i + 1 < modules.size()) ? modules[i + 1] : end;
+			line += std::count(lineAt, modules[i], '\n');
+			lineAt = modules[i];
+			Parser moduleParser(modules[i], last, line);
+			bool body;
+
+			auto mod = moduleParser.parseModuleHeader(body);
+
+			if (body) {
+				const char *first = moduleParser.bodyStart();
+				int bodyLine = line + std::count(modules[i], first, '\n');
+				std::string id = mod->getId();
+				mod->setStatementLoader([owner, arena, first, last, bodyLine,
+										 id] () {
+					ArenaScope scope(arena);
+					try {
+						Parser bodyParser(first, last, bodyLine);
+						return bodyParser.parseStmtFragment();
+					} catch (ParseError &e) {
+						throw std::runtime_error("Parse error in body of module "
+								+ id + ", " + e.what());
+					}
+				});
+			}
+
+			mIR->addModule(mod);
+		}
+	} catch (ParseError &e) {
+		std::cerr << "Parse error: " << e.what() << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+}
+}
+}
@@ -0,0 +1,354 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "FirrtlRDFrontendLexer.h"
+#include "FirrtlatorScanner.h"
+
+namespace Firrtlator {
+namespace Frontend {
+namespace FirrtlRD {
+
+ParseError::ParseError(int line, std::string msg)
+: std::runtime_error("line " + std::to_string(line) + ": " + msg),
+  mLine(line) {}
+
+static inline bool isIdStart(char c) {
+	return ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z'))
+			|| (c == '_');
+}
+
+static inline bool isIdChar(char c) {
+	return isIdStart(c) || ((c >= '0') && (c <= '9'));
+}
+
+static inline bool isDigit(char c) {
+	return (c >= '0') && (c <= '9');
+}
+
+Lexer::Lexer(const char *begin, const char *end, int line)
+: mBegin(begin), mCur(begin), mEnd(end), mLine(line), mLineStart(true), mParens(0),
+  mPendingDedents(0) {
+	lex();
+}
+
+Token Lexer::next() {
+	Token t = mToken;
+	lex();
+	return t;
+}
+
+const char *Lexer::lineStart() {
+	const char *p = mToken.begin;
+	while ((p != mBegin) && (p[-1] != '\n'))
+		p--;
+	return p;
+}
+
+void Lexer::make(Token::Kind kind, const char *begin, const char *end) {
+	mToken.kind = kind;
+	mToken.begin = begin;
+	mToken.end = end;
+	mToken.line = mLine;
+	mToken.keyword = Keywords::NONE;
+	mToken.op = PrimOp::UNDEFINED;
+}
+
+bool Lexer::handleLineStart() {
+	while (mCur != mEnd) {
+		const char *p = Scanner::skipBlanks(mCur, mEnd);
+
+		if (p == mEnd) {
+			mCur = p;
+			break;
+		}
+
+		if ((*p == '\n') || (*p == '\r') || (*p == '\f')) {
+			// Empty lines do not change the indentation
+			if (*p == '\n')
+				mLine++;
+			mCur = p + 1;
+			continue;
+		}
+
+		if (*p == ';') {
+			// Neither do lines that only contain a comment
+			mCur = Scanner::findByte(p, mEnd, '\n');
+			continue;
+		}
+
+		int level = p - mCur;
+		mCur = p;
+		mLineStart = false;
+
+		if (mLevels.empty()) {
+			mLevels.push_back(level);
+			return false;
+		}
+
+		if (level == mLevels.back())
+			return false;
+
+		if (level > mLevels.back()) {
+			mLevels.push_back(level);
+			make(Token::INDENT, mCur, mCur);
+			return true;
+		}
+
+		while (level < mLevels.back()) {
+			mLevels.pop_back();
+			mPendingDedents++;
+			if (mLevels.empty() || (level > mLevels.back()))
+				throw ParseError(mLine, "Dedenting failed, could not find "
+						"matching indentation");
+		}
+
+		mPendingDedents--;
+		make(Token::DEDENT, mCur, mCur);
+		return true;
+	}
+
+	mLineStart = false;
+	return false;
+}
+
+void Lexer::skipWhitespace() {
+	while (mCur != mEnd) {
+		char c = *mCur;
+		if ((c == ' ') || (c == '\t') || (c == ',') || (c == '\r')
+				|| (c == '\f')) {
+			mCur++;
+		} else if (c == '\n') {
+			mLine++;
+			mCur++;
+			if (mParens == 0) {
+				mLineStart = true;
+				return;
+			}
+		} else if (c == ';') {
+			mCur = Scanner::findByte(mCur, mEnd, '\n');
+		} else {
+			return;
+		}
+	}
+}
+
+void Lexer::lex() {
+	if (mPendingDedents > 0) {
+		mPendingDedents--;
+		make(Token::DEDENT, mCur, mCur);
+		return;
+	}
+
+	while (true) {
+		if (mLineStart && handleLineStart())
+			return;
+
+		skipWhitespace();
+
+		if (!mLineStart)
+			break;
+	}
+
+	if (mCur == mEnd) {
+		if (mLevels.size() > 1) {
+			mLevels.pop_back();
+			make(Token::DEDENT, mCur, mCur);
+		} else {
+			make(Token::END, mCur, mCur);
+		}
+		return;
+	}
+
+	const char *start = mCur;
+	char c = *mCur;
+
+	if (isIdStart(c)) {
+		mCur++;
+		while (mCur != mEnd) {
+			if (isIdChar(*mCur)) {
+				mCur++;
+			} else if ((*mCur == '-') && (mCur + 1 != mEnd)
+					&& isIdStart(mCur[1])) {
+				// Memory fields such as data-type and read-latency
+				mCur++;
+			} else {
+				break;
+			}
+		}
+		make(Token::IDENTIFIER, start, mCur);
+		const Keywords::Entry *e = Keywords::lookup(start, mCur - start);
+		if (e) {
+			mToken.keyword = e->keyword;
+			mToken.op = e->op;
+		}
+		return;
+	}
+
+	if (isDigit(c) || ((c == '-') && (mCur + 1 != mEnd) && isDigit(mCur[1]))) {
+		lexNumber();
+		return;
+	}
+
+	switch (c) {
+	case '"':
+		lexString('"', Token::STRING_DOUBLE);
+		return;
+	case '\'':
+		lexString('\'', Token::STRING_SINGLE);
+		return;
+	case '@':
+		if ((mCur + 1 != mEnd) && (mCur[1] == '[')) {
+			const char *p = Scanner::findByte(mCur + 2, mEnd, ']');
+			if (p == mEnd)
+				throw ParseError(mLine, "Unterminated info");
+			make(Token::INFO, mCur + 2, p);
+			mCur = p + 1;
+			return;
+		}
+		break;
+	case '<':
+		mCur++;
+		if ((mCur != mEnd) && (*mCur == '=')) {
+			mCur++;
+			make(Token::CONNECT, start, mCur);
+		} else if ((mCur != mEnd) && (*mCur == '-')) {
+			mCur++;
+			make(Token::PARTCONNECT, start, mCur);
+		} else {
+			make(Token::LT, start, mCur);
+		}
+		return;
+	case '=':
+		mCur++;
+		if ((mCur != mEnd) && (*mCur == '>')) {
+			mCur++;
+			make(Token::ASSIGN, start, mCur);
+		} else {
+			make(Token::EQUAL, start, mCur);
+		}
+		return;
+	case '(':
+	case '{':
+		mParens++;
+		mCur++;
+		make((c == '(') ? Token::LPAREN : Token::LBRACE, start, mCur);
+		return;
+	case ')':
+	case '}':
+		if (mParens > 0)
+			mParens--;
+		mCur++;
+		make((c == ')') ? Token::RPAREN : Token::RBRACE, start, mCur);
+		return;
+	case ':': mCur++; make(Token::COLON, start, mCur); return;
+	case '>': mCur++; make(Token::GT, start, mCur); return;
+	case '.': mCur++; make(Token::DOT, start, mCur); return;
+	case '[': mCur++; make(Token::LBRACKET, start, mCur); return;
+	case ']': mCur++; make(Token::RBRACKET, start, mCur); return;
+	default:
+		break;
+	}
+
+	throw ParseError(mLine, std::string("Unexpected character '") + c + "'");
+}
+
+void Lexer::lexNumber() {
+	const char *start = mCur;
+
+	if (*mCur == '-')
+		mCur++;
+
+	if ((*mCur == '0') && (mCur + 1 != mEnd)
+			&& ((mCur[1] == 'x') || (mCur[1] == 'o') || (mCur[1] == 'b'))) {
+		mCur += 2;
+		while ((mCur != mEnd) && (isIdChar(*mCur)))
+			mCur++;
+		make(Token::INT, start, mCur);
+		return;
+	}
+
+	while ((mCur != mEnd) && isDigit(*mCur))
+		mCur++;
+
+	if ((mCur != mEnd) && (*mCur == '.') && (mCur + 1 != mEnd)
+			&& isDigit(mCur[1])) {
+		mCur++;
+		while ((mCur != mEnd) && isDigit(*mCur))
+			mCur++;
+		make(Token::DOUBLE, start, mCur);
+		return;
+	}
+
+	make(Token::INT, start, mCur);
+}
+
+void Lexer::lexString(char quote, Token::Kind kind) {
+	const char *p = mCur + 1;
+
+	while ((p != mEnd) && (*p != quote)) {
+		if (*p == '\n')
+			break;
+		if ((*p == '\\') && (p + 1 != mEnd))
+			p++;
+		p++;
+	}
+
+	if ((p == mEnd) || (*p != quote))
+		throw ParseError(mLine, "Unterminated string");
+
+	// The token only covers the content of the string
+	make(kind, mCur + 1, p);
+	mCur = p + 1;
+}
+
+const char *Lexer::kindName(Token::Kind kind) {
+	switch (kind) {
+	case Token::IDENTIFIER: return "identifier";
+	case Token::INT: return "integer";
+	case Token::DOUBLE: return "double";
+	case Token::STRING_DOUBLE: return "string";
+	case Token::STRING_SINGLE: return "string";
+	case Token::INFO: return "info";
+	case Token::COLON: return "':'";
+	case Token::LT: return "'<'";
+	case Token::GT: return "'>'";
+	case Token::LPAREN: return "'('";
+	case Token::RPAREN: return "')'";
+	case Token::EQUAL: return "'='";
+	case Token::LBRACE: return "'{'";
+	case Token::RBRACE: return "'}'";
+	case Token::DOT: return "'.'";
+	case Token::LBRACKET: return "'['";
+	case Token::RBRACKET: return "']'";
+	case Token::CONNECT: return "'<='";
+	case Token::PARTCONNECT: return "'<-'";
+	case Token::ASSIGN: return "'=>'";
+	case Token::INDENT: return "indentation";
+	case Token::DEDENT: return "dedentation";
+	case Token::END: return "end of input";
+	}
+	return "token";
+}
+
+}
+}
+}
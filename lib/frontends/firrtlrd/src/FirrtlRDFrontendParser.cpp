@@ -0,0 +1,640 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "FirrtlRDFrontendParser.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+
+namespace Firrtlator {
+namespace Frontend {
+namespace FirrtlRD {
+
+Parser::Parser(const char *begin, const char *end, int line)
+: mLexer(begin, end, line) {}
+
+void Parser::error(std::string expected) {
+	const Token &t = mLexer.peek();
+	std::string found = Lexer::kindName(t.kind);
+	if (t.kind == Token::IDENTIFIER)
+		found += " '" + t.text() + "'";
+	throw ParseError(t.line, "Expected " + expected + ", found " + found);
+}
+
+Token Parser::expect(Token::Kind kind) {
+	if (mLexer.peek().kind != kind)
+		error(Lexer::kindName(kind));
+	return mLexer.next();
+}
+
+void Parser::expectKeyword(Keywords::Keyword keyword) {
+	if (!mLexer.peek().is(keyword))
+		error(std::string("'") + Keywords::name(keyword) + "'");
+	mLexer.next();
+}
+
+bool Parser::accept(Token::Kind kind) {
+	if (mLexer.peek().kind != kind)
+		return false;
+	mLexer.next();
+	return true;
+}
+
+bool Parser::acceptKeyword(Keywords::Keyword keyword) {
+	if (!mLexer.peek().is(keyword))
+		return false;
+	mLexer.next();
+	return true;
+}
+
+Symbol Parser::parseIdentifier() {
+	return expect(Token::IDENTIFIER).symbol();
+}
+
+int Parser::parseInt() {
+	Token t = expect(Token::INT);
+	std::string s = t.text();
+	const char *p = s.c_str();
+	bool neg = (*p == '-');
+	if (neg)
+		p++;
+
+	int base = 10;
+	if ((p[0] == '0') && (p[1] == 'x')) {
+		base = 16;
+		p += 2;
+	} else if ((p[0] == '0') && (p[1] == 'o')) {
+		base = 8;
+		p += 2;
+	} else if ((p[0] == '0') && (p[1] == 'b')) {
+		base = 2;
+		p += 2;
+	}
+
+	char *end;
+	errno = 0;
+	long v = strtol(p, &end, base);
+	if (*end != 0)
+		throw ParseError(t.line, "Invalid integer '" + s + "'");
+	if ((errno == ERANGE) || (v > (neg ? -(long) INT_MIN : INT_MAX)))
+		throw ParseError(t.line, "Integer out of range '" + s + "'");
+
+	return neg ? -v : v;
+}
+
+std::shared_ptr<Info> Parser::parseInfo() {
+	if (mLexer.peek().kind != Token::INFO)
+		return nullptr;
+	Token t = mLexer.next();
+	return mInfos.get(t.begin, t.end);
+}
+
+std::shared_ptr<Circuit> Parser::parseCircuit() {
+	expectKeyword(Keywords::CIRCUIT);
+	auto circuit = make_node<Circuit>(parseIdentifier());
+	expect(Token::COLON);
+	circuit->setInfo(parseInfo());
+
+	if (accept(Token::INDENT)) {
+		while (mLexer.peek().is(Keywords::MODULE) || mLexer.peek().is(Keywords::EXTMODULE))
+			circuit->addModule(parseModule());
+		expect(Token::DEDENT);
+	}
+
+	expect(Token::END);
+
+	return circuit;
+}
+
+std::shared_ptr<Module> Parser::parseModule() {
+	bool body;
+	auto mod = parseModuleHeader(body);
+
+	if (body) {
+		mod->setStatementGroup(parseStmtGroup());
+		expect(Token::DEDENT);
+	}
+
+	return mod;
+}
+
+std::shared_ptr<Module> Parser::parseModuleHeader(bool &body) {
+	body = false;
+
+	bool external = mLexer.next().is(Keywords::EXTMODULE);
+	auto mod = make_node<Module>(parseIdentifier(), external);
+	expect(Token::COLON);
+	mod->setInfo(parseInfo());
+
+	if (!accept(Token::INDENT))
+		return mod;
+
+	while (mLexer.peek().is(Keywords::INPUT) || mLexer.peek().is(Keywords::OUTPUT))
+		mod->addPort(parsePort());
+
+	if (!external) {
+		body = true;
+		return mod;
+	}
+
+	if (acceptKeyword(Keywords::DEFNAME)) {
+		expect(Token::EQUAL);
+		mod->setDefname(parseIdentifier());
+	}
+	while (mLexer.peek().is(Keywords::PARAMETER))
+		mod->addParameter(parseParameter());
+
+	expect(Token::DEDENT);
+
+	return mod;
+}
+
+const char *Parser::bodyStart() {
+	return mLexer.lineStart();
+}
+
+std::shared_ptr<StmtGroup> Parser::parseStmtFragment() {
+	auto group = parseStmtGroup();
+	expect(Token::END);
+	return group;
+}
+
+std::shared_ptr<Port> Parser::parsePort() {
+	Port::Direction dir = mLexer.next().is(Keywords::INPUT) ?
+			Port::Direction::INPUT : Port::Direction::OUTPUT;
+	Symbol id = parseIdentifier();
+	expect(Token::COLON);
+	auto port = make_node<Port>(id, dir, parseType());
+	port->setInfo(parseInfo());
+	return port;
+}
+
+std::shared_ptr<Parameter> Parser::parseParameter() {
+	expectKeyword(Keywords::PARAMETER);
+	parseIdentifier();
+	expect(Token::EQUAL);
+
+	switch (mLexer.peek().kind) {
+	case Token::INT:
+	case Token::DOUBLE:
+	case Token::STRING_DOUBLE:
+	case Token::STRING_SINGLE:
+		mLexer.next();
+		break;
+	default:
+		error("parameter value");
+	}
+
+	return make_node<Parameter>();
+}
+
+std::shared_ptr<Type> Parser::parseType() {
+	std::shared_ptr<Type> type;
+	const Token &t = mLexer.peek();
+
+	if (t.is(Keywords::UINT) || t.is(Keywords::SINT)) {
+		type = parseTypeInt();
+	} else if (t.is(Keywords::CLOCK)) {
+		mLexer.next();
+		type = make_node<TypeClock>();
+	} else if (t.kind == Token::LBRACE) {
+		type = parseTypeBundle();
+	} else {
+		error("type");
+	}
+
+	while (accept(Token::LBRACKET)) {
+		int size = parseInt();
+		expect(Token::RBRACKET);
+		type = make_node<TypeVector>(type, size);
+	}
+
+	return type;
+}
+
+std::shared_ptr<TypeInt> Parser::parseTypeInt() {
+	auto type = make_node<TypeInt>(mLexer.next().is(Keywords::SINT));
+
+	if (accept(Token::LT)) {
+		type->setWidth(parseInt());
+		expect(Token::GT);
+	}
+
+	return type;
+}
+
+std::shared_ptr<TypeBundle> Parser::parseTypeBundle() {
+	expect(Token::LBRACE);
+	auto bundle = make_node<TypeBundle>();
+
+	while (!accept(Token::RBRACE))
+		bundle->addField(parseField());
+
+	return bundle;
+}
+
+std::shared_ptr<Field> Parser::parseField() {
+	bool flip = acceptKeyword(Keywords::FLIP);
+	Symbol id = parseIdentifier();
+	expect(Token::COLON);
+	return make_node<Field>(id, parseType(), flip);
+}
+
+bool Parser::atStmt() {
+	const Token &t = mLexer.peek();
+	return (t.kind != Token::DEDENT) && (t.kind != Token::END)
+			&& !t.is(Keywords::ELSE);
+}
+
+std::shared_ptr<StmtGroup> Parser::parseStmtGroup() {
+	auto group = make_node<StmtGroup>();
+
+	while (atStmt())
+		group->addStatement(parseStmt());
+
+	return group;
+}
+
+std::shared_ptr<StmtGroup> Parser::parseStmtBlock(int line) {
+	if (accept(Token::INDENT)) {
+		auto group = parseStmtGroup();
+		expect(Token::DEDENT);
+		return group;
+	}
+
+	// Statements on the same line as the colon
+	auto group = make_node<StmtGroup>();
+	while (atStmt() && (mLexer.peek().line == line))
+		group->addStatement(parseStmt());
+
+	return group;
+}
+
+std::shared_ptr<Stmt> Parser::parseStmt() {
+	const Token &t = mLexer.peek();
+
+	if (t.kind != Token::IDENTIFIER)
+		error("statement");
+
+	switch (t.keyword) {
+	case Keywords::WIRE: return parseWire();
+	case Keywords::REG: return parseReg();
+	case Keywords::MEM: return parseMem();
+	case Keywords::INST: return parseInst();
+	case Keywords::NODE: return parseNode();
+	case Keywords::WHEN: return parseConditional();
+	case Keywords::STOP: return parseStop();
+	case Keywords::PRINTF: return parsePrintf();
+	case Keywords::SKIP: return parseEmpty();
+	default: return parseExpStmt();
+	}
+}
+
+std::shared_ptr<Stmt> Parser::parseWire() {
+	mLexer.next();
+	Symbol id = parseIdentifier();
+	expect(Token::COLON);
+	auto wire = make_node<Wire>(id, parseType());
+	wire->setInfo(parseInfo());
+	return wire;
+}
+
+std::shared_ptr<Stmt> Parser::parseReg() {
+	mLexer.next();
+	Symbol id = parseIdentifier();
+	expect(Token::COLON);
+	std::shared_ptr<Type> type = parseType();
+	auto reg = make_node<Reg>(id, type, parseExp());
+
+	if (acceptKeyword(Keywords::WITH)) {
+		expect(Token::COLON);
+		expect(Token::LPAREN);
+		expectKeyword(Keywords::RESET);
+		expect(Token::ASSIGN);
+		expect(Token::LPAREN);
+		reg->setResetTrigger(parseExp());
+		reg->setResetValue(parseExp());
+		expect(Token::RPAREN);
+		expect(Token::RPAREN);
+	}
+
+	reg->setInfo(parseInfo());
+	return reg;
+}
+
+std::shared_ptr<Stmt> Parser::parseMem() {
+	mLexer.next();
+	auto mem = make_node<Memory>(parseIdentifier());
+	expect(Token::COLON);
+	std::shared_ptr<Info> info = parseInfo();
+
+	// The fields are either in parentheses or an indented block
+	if (accept(Token::LPAREN)) {
+		if (!info)
+			info = parseInfo();
+		while (!accept(Token::RPAREN))
+			parseMemField(mem);
+	} else {
+		expect(Token::INDENT);
+		while (!accept(Token::DEDENT))
+			parseMemField(mem);
+	}
+
+	mem->setInfo(info);
+	return mem;
+}
+
+void Parser::parseMemField(std::shared_ptr<Memory> mem) {
+	Token field = expect(Token::IDENTIFIER);
+	expect(Token::ASSIGN);
+
+	if (field.is(Keywords::DATA_TYPE)) {
+		mem->setDType(parseType());
+	} else if (field.is(Keywords::DEPTH)) {
+		mem->setDepth(parseInt());
+	} else if (field.is(Keywords::READ_LATENCY)) {
+		mem->setReadLatency(parseInt());
+	} else if (field.is(Keywords::WRITE_LATENCY)) {
+		mem->setWriteLatency(parseInt());
+	} else if (field.is(Keywords::READ_UNDER_WRITE)) {
+		if (acceptKeyword(Keywords::OLD))
+			mem->setRuwFlag(Memory::RuwFlag::OLD);
+		else if (acceptKeyword(Keywords::NEW))
+			mem->setRuwFlag(Memory::RuwFlag::NEW);
+		else if (acceptKeyword(Keywords::UNDEFINED))
+			mem->setRuwFlag(Memory::RuwFlag::UNDEFINED);
+		else
+			error("'old', 'new' or 'undefined'");
+	} else if (field.is(Keywords::READER)) {
+		mem->addReader(parseIdentifier());
+	} else if (field.is(Keywords::WRITER)) {
+		mem->addWriter(parseIdentifier());
+	} else if (field.is(Keywords::READWRITER)) {
+		mem->addReadWriter(parseIdentifier());
+	} else {
+		throw ParseError(field.line, "Unknown memory field '"
+				+ field.text() + "'");
+	}
+}
+
+std::shared_ptr<Stmt> Parser::parseInst() {
+	mLexer.next();
+	Symbol id = parseIdentifier();
+	expectKeyword(Keywords::OF);
+	auto of = make_node<Reference>(parseIdentifier());
+	auto inst = make_node<Instance>(id, of);
+	inst->setInfo(parseInfo());
+	return inst;
+}
+
+std::shared_ptr<Stmt> Parser::parseNode() {
+	mLexer.next();
+	Symbol id = parseIdentifier();
+	expect(Token::EQUAL);
+	auto node = make_node<Node>(id, parseExp());
+	node->setInfo(parseInfo());
+	return node;
+}
+
+std::shared_ptr<Conditional> Parser::parseConditional() {
+	std::shared_ptr<Conditional> first;
+	std::shared_ptr<ConditionalElse> otherwise;
+
+	// Chains of else when are parsed in a loop, each conditional goes to
+	// the else of the one before
+	while (true) {
+		expectKeyword(Keywords::WHEN);
+		auto cond = make_node<Conditional>(parseExp());
+		int line = expect(Token::COLON).line;
+		cond->setInfo(parseInfo());
+		cond->setThen(parseStmtBlock(line));
+
+		if (otherwise)
+			otherwise->setStmts(make_node<StmtGroup>(cond));
+		else
+			first = cond;
+
+		if (!acceptKeyword(Keywords::ELSE))
+			return first;
+
+		otherwise = make_node<ConditionalElse>();
+		cond->setElse(otherwise);
+
+		if (!mLexer.peek().is(Keywords::WHEN)) {
+			line = expect(Token::COLON).line;
+			otherwise->setInfo(parseInfo());
+			otherwise->setStmts(parseStmtBlock(line));
+			return first;
+		}
+	}
+}
+
+std::shared_ptr<Stmt> Parser::parseStop() {
+	mLexer.next();
+	expect(Token::LPAREN);
+	std::shared_ptr<Expression> clock = parseExp();
+	std::shared_ptr<Expression> cond = parseExp();
+	auto stop = make_node<Stop>(clock, cond, parseInt());
+	expect(Token::RPAREN);
+	stop->setInfo(parseInfo());
+	return stop;
+}
+
+std::shared_ptr<Stmt> Parser::parsePrintf() {
+	mLexer.next();
+	expect(Token::LPAREN);
+	std::shared_ptr<Expression> clock = parseExp();
+	std::shared_ptr<Expression> cond = parseExp();
+	std::string format = expect(Token::STRING_DOUBLE).text();
+	auto print = make_node<Printf>(clock, cond, format);
+
+	while (!accept(Token::RPAREN))
+		print->addArgument(parseExp());
+
+	print->setInfo(parseInfo());
+	return print;
+}
+
+std::shared_ptr<Stmt> Parser::parseEmpty() {
+	mLexer.next();
+	auto empty = make_node<Empty>();
+	empty->setInfo(parseInfo());
+	return empty;
+}
+
+std::shared_ptr<Stmt> Parser::parseExpStmt() {
+	std::shared_ptr<Expression> exp = parseExp();
+	std::shared_ptr<Stmt> stmt;
+
+	// The expression is parsed once, the operator decides the statement
+	if (accept(Token::CONNECT)) {
+		stmt = make_node<Connect>(exp, parseExp());
+	} else if (accept(Token::PARTCONNECT)) {
+		stmt = make_node<Connect>(exp, parseExp(), true);
+	} else if (acceptKeyword(Keywords::IS)) {
+		expectKeyword(Keywords::INVALID);
+		stmt = make_node<Invalid>(exp);
+	} else {
+		error("'<=', '<-' or 'is invalid'");
+	}
+
+	stmt->setInfo(parseInfo());
+	return stmt;
+}
+
+std::shared_ptr<Expression> Parser::parseExp() {
+	// The operations whose operands are still parsed are kept on a stack
+	// instead of the call stack, so nesting depth is not limited
+	mOpenExps.clear();
+	mOperands.clear();
+
+	while (true) {
+		std::shared_ptr<Expression> exp = parseOperand();
+
+		while (exp) {
+			exp = parseExpSuffix(exp);
+			if (!exp)
+				break;
+			if (mOpenExps.empty())
+				return exp;
+			exp = addOperand(exp);
+		}
+	}
+}
+
+std::shared_ptr<Expression> Parser::parseOperand() {
+	const Token &t = mLexer.peek();
+
+	if (t.kind != Token::IDENTIFIER)
+		error("expression");
+
+	if (t.is(Keywords::UINT) || t.is(Keywords::SINT))
+		return parseConstant(parseTypeInt());
+
+	if (t.is(Keywords::MUX) || t.is(Keywords::VALIDIF)) {
+		OpenExp::Kind kind = mLexer.next().is(Keywords::MUX) ?
+				OpenExp::MUX : OpenExp::VALIDIF;
+		expect(Token::LPAREN);
+		mOpenExps.push_back({ kind, nullptr, mOperands.size() });
+		return nullptr;
+	}
+
+	Token id = mLexer.next();
+	const Token &n = mLexer.peek();
+
+	// Primitive operations are directly followed by the parenthesis
+	if ((n.kind == Token::LPAREN) && (n.begin == id.end)
+			&& id.is(Keywords::PRIMOP)) {
+		std::shared_ptr<Expression> primop = PrimOp::generate(id.op);
+		expect(Token::LPAREN);
+		mOpenExps.push_back({ OpenExp::PRIMOP, primop, 0 });
+		return addOperand(nullptr);
+	}
+
+	return make_node<Reference>(id.symbol());
+}
+
+std::shared_ptr<Expression> Parser::parseExpSuffix(
+		std::shared_ptr<Expression> exp) {
+	while (true) {
+		if (accept(Token::DOT)) {
+			auto field = make_node<Reference>(parseIdentifier());
+			exp = make_node<SubField>(field, exp);
+		} else if (accept(Token::LBRACKET)) {
+			if (mLexer.peek().kind != Token::INT) {
+				mOpenExps.push_back({ OpenExp::ACCESS, exp, 0 });
+				return nullptr;
+			}
+			exp = make_node<SubIndex>(parseInt(), exp);
+			expect(Token::RBRACKET);
+		} else {
+			return exp;
+		}
+	}
+}
+
+std::shared_ptr<Expression> Parser::addOperand(
+		std::shared_ptr<Expression> exp) {
+	OpenExp &op = mOpenExps.back();
+	std::shared_ptr<Expression> result;
+
+	if (op.kind == OpenExp::PRIMOP) {
+		auto primop = std::static_pointer_cast<PrimOp>(op.exp);
+		if (exp)
+			primop->addOperand(exp);
+
+		if ((mLexer.peek().kind != Token::INT)
+				&& (mLexer.peek().kind != Token::RPAREN))
+			return nullptr;
+
+		while (mLexer.peek().kind == Token::INT)
+			primop->addParameter(parseInt());
+		expect(Token::RPAREN);
+		result = primop;
+	} else if (op.kind == OpenExp::ACCESS) {
+		expect(Token::RBRACKET);
+		result = make_node<SubAccess>(exp, op.exp);
+	} else {
+		mOperands.push_back(exp);
+		size_t count = (op.kind == OpenExp::MUX) ? 3 : 2;
+		if (mOperands.size() - op.operands < count)
+			return nullptr;
+
+		expect(Token::RPAREN);
+		auto first = mOperands.begin() + op.operands;
+		if (op.kind == OpenExp::MUX)
+			result = make_node<Mux>(first[0], first[1], first[2]);
+		else
+			result = make_node<CondValid>(first[0], first[1]);
+		mOperands.erase(first, mOperands.end());
+	}
+
+	mOpenExps.pop_back();
+	return result;
+}
+
+std::shared_ptr<Constant> Parser::parseConstant(
+		std::shared_ptr<TypeInt> type) {
+	std::shared_ptr<Constant> c;
+
+	expect(Token::LPAREN);
+	Constant::GenerateHint hint = Constant::INT;
+	if (mLexer.peek().kind == Token::STRING_DOUBLE)
+		hint = Constant::STRING;
+	else if (mLexer.peek().kind != Token::INT)
+		error("integer or string");
+	Token t = mLexer.next();
+
+	try {
+		c = make_node<Constant>(type, t.symbol(), hint);
+	} catch (std::runtime_error &e) {
+		throw ParseError(t.line, e.what());
+	}
+	expect(Token::RPAREN);
+
+	return c;
+}
+
+}
+}
+}
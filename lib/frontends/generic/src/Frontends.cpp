@@ -33,6 +33,30 @@ std::shared_ptr<Circuit> FrontendBase::getIR() {
 	return mIR;
 }
 
+void FrontendBase::setThreads(unsigned threads) {
+	mThreads = threads;
+}
+
+void FrontendBase::setInputOwner(std::shared_ptr<const void> owner) {
+	mInputOwner = owner;
+}
+
+std::shared_ptr<Info> InfoCache::get(const char *begin, const char *end) {
+	Info info(begin, end);
+
+	auto it = mInfos.find(info);
+	if (it != mInfos.end())
+		return it->second;
+
+	auto shared = make_node<Info>(info);
+	mInfos.emplace(info, shared);
+	return shared;
+}
+
+std::shared_ptr<Info> InfoCache::get(const std::string &value) {
+	return get(value.data(), value.data() + value.size());
+}
+
 void Registry::registerFrontend(const std::string &name,
 	FrontendFactory* factory) {
 	getFrontendMap()[name] = factory;
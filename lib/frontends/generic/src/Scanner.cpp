@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "FirrtlatorScanner.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SCANNER_X86
+#endif
+
+namespace Firrtlator {
+namespace Frontend {
+namespace Scanner {
+
+typedef const char *(*FindByteFunction)(const char *, const char *, char);
+typedef const char *(*SkipBlanksFunction)(const char *, const char *);
+
+static const char *findByteScalar(const char *begin, const char *end,
+		char c) {
+	while ((begin != end) && (*begin != c))
+		begin++;
+	return begin;
+}
+
+static const char *skipBlanksScalar(const char *begin, const char *end) {
+	while ((begin != end) && ((*begin == ' ') || (*begin == '\t')))
+		begin++;
+	return begin;
+}
+
+#if defined(SCANNER_X86) && defined(__SSE2__)
+static const char *findByteSSE2(const char *begin, const char *end,
+		char c) {
+	const __m128i needle = _mm_set1_epi8(c);
+
+	while (end - begin >= 16) {
+		__m128i v = _mm_loadu_si128((const __m128i*) begin);
+		unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+		if (mask)
+			return begin + __builtin_ctz(mask);
+		begin += 16;
+	}
+
+	return findByteScalar(begin, end, c);
+}
+
+static const char *skipBlanksSSE2(const char *begin, const char *end) {
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i tab = _mm_set1_epi8('\t');
+
+	while (end - begin >= 16) {
+		__m128i v = _mm_loadu_si128((const __m128i*) begin);
+		__m128i blank = _mm_or_si128(_mm_cmpeq_epi8(v, space),
+				_mm_cmpeq_epi8(v, tab));
+		unsigned mask = ~_mm_movemask_epi8(blank) & 0xffff;
+		if (mask)
+			return begin + __builtin_ctz(mask);
+		begin += 16;
+	}
+
+	return skipBlanksScalar(begin, end);
+}
+#endif
+
+#ifdef SCANNER_X86
+__attribute__ ((target ("avx2")))
+static const char *findByteAVX2(const char *begin, const char *end,
+		char c) {
+	const __m256i needle = _mm256_set1_epi8(c);
+
+	while (end - begin >= 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i*) begin);
+		unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle));
+		if (mask)
+			return begin + __builtin_ctz(mask);
+		begin += 32;
+	}
+
+	return findByteScalar(begin, end, c);
+}
+
+__attribute__ ((target ("avx2")))
+static const char *skipBlanksAVX2(const char *begin, const char *end) {
+	const __m256i space = _mm256_set1_epi8(' ');
+	const __m256i tab = _mm256_set1_epi8('\t');
+
+	while (end - begin >= 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i*) begin);
+		__m256i blank = _mm256_or_si256(_mm256_cmpeq_epi8(v, space),
+				_mm256_cmpeq_epi8(v, tab));
+		unsigned mask = ~(unsigned) _mm256_movemask_epi8(blank);
+		if (mask)
+			return begin + __builtin_ctz(mask);
+		begin += 32;
+	}
+
+	return skipBlanksScalar(begin, end);
+}
+#endif
+
+static FindByteFunction selectFindByte() {
+#ifdef SCANNER_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return findByteAVX2;
+#ifdef __SSE2__
+	return findByteSSE2;
+#endif
+#endif
+	return findByteScalar;
+}
+
+static SkipBlanksFunction selectSkipBlanks() {
+#ifdef SCANNER_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return skipBlanksAVX2;
+#ifdef __SSE2__
+	return skipBlanksSSE2;
+#endif
+#endif
+	return skipBlanksScalar;
+}
+
+static const FindByteFunction findByteImpl = selectFindByte();
+static const SkipBlanksFunction skipBlanksImpl = selectSkipBlanks();
+
+const char *findByte(const char *begin, const char *end, char c) {
+	return findByteImpl(begin, end, c);
+}
+
+const char *skipBlanks(const char *begin, const char *end) {
+	return skipBlanksImpl(begin, end);
+}
+
+static bool startsWithKeyword(const char *begin, const char *end,
+		const char *keyword) {
+	size_t len = strlen(keyword);
+	if ((size_t) (end - begin) <= len)
+		return false;
+	if (memcmp(begin, keyword, len) != 0)
+		return false;
+	return (begin[len] == ' ') || (begin[len] == '\t');
+}
+
+std::vector<const char*> findModules(const char *begin, const char *end) {
+	std::vector<const char*> modules;
+
+	for (const char *line = begin; line != end; ) {
+		const char *p = skipBlanks(line, end);
+
+		if (startsWithKeyword(p, end, "module")
+				|| startsWithKeyword(p, end, "extmodule"))
+			modules.push_back(line);
+
+		line = findByte(p, end, '\n');
+		if (line != end)
+			line++;
+	}
+
+	return modules;
+}
+
+}
+}
+}
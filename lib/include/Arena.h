@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+namespace Firrtlator {
+
+/*
+ * Bump allocator for IR nodes. Memory is taken from large blocks and only
+ * released when the arena is destroyed. Nodes allocated with make_node()
+ * keep their arena alive, so the arena goes away with the last of its
+ * nodes and the last shared_ptr from create(). An arena must only be used
+ * by one thread at a time.
+ */
+class
+__attribute__ ((visibility ("default")))
+Arena {
+public:
+	static std::shared_ptr<Arena> create(size_t blockSize = 1 << 20);
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	void *allocate(size_t size, size_t align);
+	size_t getAllocated() { return mAllocated; }
+
+	// The nodes hold a plain reference, which is smaller than a shared_ptr
+	void acquire() { mRefs++; }
+	void release() { if (--mRefs == 0) delete this; }
+
+	// The arena used by make_node() on this thread, may be null
+	static Arena *current();
+	static void setCurrent(Arena *arena);
+private:
+	Arena(size_t blockSize);
+	~Arena();
+
+	std::vector<char*> mBlocks;
+	char *mCur;
+	char *mEnd;
+	size_t mBlockSize;
+	size_t mAllocated;
+	std::atomic<size_t> mRefs;
+};
+
+// Sets the current arena of this thread for its lifetime
+class
+__attribute__ ((visibility ("default")))
+ArenaScope {
+public:
+	ArenaScope(std::shared_ptr<Arena> arena)
+	: mArena(arena), mPrevious(Arena::current()) {
+		Arena::setCurrent(arena.get());
+	}
+	~ArenaScope() { Arena::setCurrent(mPrevious); }
+	ArenaScope(const ArenaScope&) = delete;
+	ArenaScope& operator=(const ArenaScope&) = delete;
+private:
+	std::shared_ptr<Arena> mArena;
+	Arena *mPrevious;
+};
+
+template <typename T>
+class ArenaAllocator {
+public:
+	typedef T value_type;
+
+	ArenaAllocator(Arena *arena) : mArena(arena) { mArena->acquire(); }
+	ArenaAllocator(const ArenaAllocator &other) : mArena(other.mArena) {
+		mArena->acquire();
+	}
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U> &other) : mArena(other.mArena) {
+		mArena->acquire();
+	}
+	~ArenaAllocator() { mArena->release(); }
+	ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+
+	T *allocate(size_t n) {
+		return static_cast<T*>(mArena->allocate(n * sizeof(T), alignof(T)));
+	}
+	void deallocate(T*, size_t) {}
+
+	template <typename U>
+	bool operator==(const ArenaAllocator<U> &other) const {
+		return mArena == other.mArena;
+	}
+	template <typename U>
+	bool operator!=(const ArenaAllocator<U> &other) const {
+		return mArena != other.mArena;
+	}
+
+	Arena *mArena;
+};
+
+// Creates an IR node in the current arena, or on the heap if there is none
+template <typename T, typename... Args>
+std::shared_ptr<T> make_node(Args&&... args) {
+	Arena *arena = Arena::current();
+
+	if (arena)
+		return std::allocate_shared<T>(ArenaAllocator<T>(arena),
+				std::forward<Args>(args)...);
+
+	return std::make_shared<T>(std::forward<Args>(args)...);
+}
+
+}
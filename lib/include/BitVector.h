@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+
+namespace Firrtlator {
+
+/*
+ * Integer of arbitrary precision, stored as sign and magnitude. The
+ * magnitude is kept inline if it fits into 64 bits, only wider values
+ * allocate their limbs on the heap.
+ */
+class
+__attribute__ ((visibility ("default")))
+BitVector {
+public:
+	BitVector();
+	BitVector(int64_t value);
+	BitVector(const BitVector &other);
+	BitVector(BitVector &&other);
+	BitVector& operator=(BitVector other);
+	~BitVector();
+
+	/*
+	 * Parses an integer literal. Literals are decimal or carry a radix
+	 * prefix, either as in string literals ("hFF", "o17", "b101") or as in
+	 * integers (0xFF, 0o17, 0b101). They may be preceded by a minus sign
+	 * and may contain underscores as separators.
+	 */
+	static BitVector parse(const char *begin, const char *end);
+	static BitVector parse(const std::string &literal);
+
+	bool isNegative() const { return mNegative; }
+	bool isZero() const { return (mSize == 1) && (mWord == 0); }
+
+	// Number of bits of the magnitude
+	size_t getWidth() const;
+
+	// Limbs of the magnitude, least significant first
+	size_t numLimbs() const { return mSize; }
+	uint64_t getLimb(size_t i) const { return limbs()[i]; }
+
+	bool fitsInt64() const;
+	int64_t toInt64() const;
+
+	// Digits in base 2, 8, 10 or 16 with a leading minus if negative
+	std::string toString(unsigned base = 10) const;
+
+	bool operator==(const BitVector &other) const;
+	bool operator!=(const BitVector &other) const { return !(*this == other); }
+private:
+	union {
+		uint64_t mWord;
+		uint64_t *mLimbs;
+	};
+	uint32_t mSize;
+	bool mNegative;
+
+	uint64_t *limbs() { return (mSize > 1) ? mLimbs : &mWord; }
+	const uint64_t *limbs() const { return (mSize > 1) ? mLimbs : &mWord; }
+
+	void mulAdd(uint32_t mul, uint32_t add);
+	uint32_t divMod(uint32_t div);
+	void grow();
+	void shrink();
+	void release();
+	void take(BitVector &other);
+};
+
+std::ostream& operator<< (std::ostream &os, const BitVector &v);
+
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace Firrtlator {
+
+/*
+ * Sequential reader of a compressed file. The content is decompressed in
+ * chunks as it is read, so only the decompressor's window is kept in
+ * memory. Formats whose library was not found at configure time cannot be
+ * opened.
+ */
+class CompressedFile {
+public:
+	typedef enum { NONE, GZIP, ZSTD } Compression;
+
+	// Compression by the extension of filename
+	static Compression getCompression(const std::string &filename);
+	// Returns type without the extension of a compression, if any
+	static std::string stripExtension(const std::string &type);
+
+	CompressedFile(std::string filename, Compression compression);
+	~CompressedFile();
+
+	CompressedFile(const CompressedFile&) = delete;
+	CompressedFile& operator=(const CompressedFile&) = delete;
+
+	bool isOpen();
+
+	// Reads up to size bytes, returns 0 at the end of the content. Throws
+	// std::runtime_error on corrupt input.
+	size_t read(char *buffer, size_t size);
+private:
+	Compression mCompression;
+	void *mFile;
+	void *mStream;
+	std::string mInput;
+	size_t mInputPos;
+	size_t mInputSize;
+	bool mFrameOpen;
+	bool mEnd;
+};
+
+}
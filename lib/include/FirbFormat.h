@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace Firrtlator {
+namespace Firb {
+
+/*
+ * Binary serialization of the IR, written by the FIRB backend and read by
+ * the FIRB frontend. All values are 32 bit words in host byte order. The
+ * image consists of the header, the string table and the node table:
+ *
+ *   Header
+ *   uint32_t stringIndex[stringCount + 1]  offsets into the string data
+ *   char     stringData[]                  padded to a multiple of 4
+ *   uint32_t nodes[nodeWords]
+ *
+ * A node record starts with a word that holds the kind and the flags,
+ * followed by the string index of its identifier (HAS_ID) and of its
+ * locator (HAS_INFO), if any, and the fields of the kind as listed below.
+ * Child nodes are referenced by their offset in words relative to the
+ * start of the referencing record, with 0 for a missing child. Children
+ * are written before their parents. Strings are referenced by index, with
+ * index + 1 where the string is optional.
+ */
+
+const char magic[4] = { 'F', 'I', 'R', 'B' };
+const uint32_t version = 1;
+const uint32_t byteOrder = 0x01020304;
+
+struct Header {
+	char magic[4];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint32_t stringCount;
+	// Byte offsets from the start of the image
+	uint32_t stringIndex;
+	uint32_t stringData;
+	uint32_t nodes;
+	uint32_t nodeWords;
+	// Word offset of the circuit in the node table
+	uint32_t root;
+};
+
+typedef enum {
+	CIRCUIT = 1,      // count, modules
+	MODULE,           // defname + 1, count, ports, count, parameters, body
+	PORT,             // type
+	PARAMETER,        //
+	TYPE_INT,         // width
+	TYPE_CLOCK,       //
+	TYPE_BUNDLE,      // count, fields
+	FIELD,            // type
+	TYPE_VECTOR,      // type, size
+	STMT_GROUP,       // count, statements
+	WIRE,             // type
+	REG,              // type, clock, reset trigger, reset value
+	MEMORY,           // data type, depth, read latency, write latency,
+	                  // count, readers, count, writers, count, readwriters
+	INSTANCE,         // module
+	NODE,             // expression
+	CONNECT,          // to, from
+	INVALID,          // expression
+	CONDITIONAL,      // condition, then, else
+	CONDITIONAL_ELSE, // statements
+	STOP,             // clock, condition, code
+	PRINTF,           // clock, condition, format, count, arguments
+	EMPTY,            //
+	REFERENCE,        // name
+	CONSTANT,         // type, literal
+	SUB_FIELD,        // of, field
+	SUB_INDEX,        // of, index
+	SUB_ACCESS,       // of, expression
+	MUX,              // select, a, b
+	COND_VALID,       // select, a
+	PRIMOP            // count, operands, count, parameters
+} Kind;
+
+/*
+ * The fields of the kinds as above, for readers that follow the child
+ * references without decoding the records: 'c' is a child reference, 'w'
+ * any other word, 'C' and 'W' a count followed by as many of these.
+ */
+inline const char *layout(uint32_t kind) {
+	static const char *const layouts[] = {
+		nullptr, "C", "wCCc", "c", "", "w", "", "C", "c", "cw", "C", "c",
+		"cccc", "cwwwWWW", "w", "c", "cc", "c", "ccc", "c", "ccw", "ccwC",
+		"", "w", "cw", "cw", "cw", "cc", "ccc", "cc", "CW"
+	};
+
+	if (kind > PRIMOP)
+		return nullptr;
+	return layouts[kind];
+}
+
+// Layout of the first word of a record
+const uint32_t KIND_MASK = 0xff;
+const uint32_t HAS_ID = 1 << 8;
+const uint32_t HAS_INFO = 1 << 9;
+const unsigned FLAG_SHIFT = 10;
+
+// Flags of the kinds, the memory stores its read-under-write flag, the
+// constant its generate hint and the primop its operation instead
+const uint32_t FLAG_EXTERNAL = 1; // MODULE
+const uint32_t FLAG_OUTPUT = 1;   // PORT
+const uint32_t FLAG_SIGNED = 1;   // TYPE_INT
+const uint32_t FLAG_FLIP = 1;     // FIELD
+const uint32_t FLAG_PARTIAL = 1;  // CONNECT
+
+}
+}
@@ -24,6 +24,8 @@
 
 #include <vector>
 #include <memory>
+#include <string>
+#include <cstdint>
 
 namespace Firrtlator {
 
@@ -43,13 +45,66 @@ public:
 	static std::vector<FrontendDescriptor> getFrontends();
 	static std::string getFrontend(std::string type);
 
+	void setThreads(unsigned threads);
+
+	// Reuse parsed circuits stored in directory, limit is in bytes
+	// with 0 for an unlimited cache
+	void setCache(std::string directory, uint64_t limit = 0);
+
+	typedef struct {
+		uint64_t hits;
+		uint64_t misses;
+		uint64_t stores;
+		uint64_t evictions;
+		uint64_t entries;
+		uint64_t bytes;
+	} CacheStatistics;
+
+	CacheStatistics getCacheStatistics();
+
+	// Keep a hash of each module's text, the next parse only parses the
+	// modules that changed and replaces them in the current circuit
+	void setIncremental(bool incremental);
+	// Modules parsed by the last parse, which are all modules unless the
+	// parse was incremental
+	std::vector<std::string> getParsedModules();
+
 	bool parse(std::string::const_iterator begin,
 			std::string::const_iterator end, std::string type = "");
+	bool parseBuffer(const char *buffer, size_t size, std::string type = "");
 	bool parseFile(std::string filename, std::string type = "");
-	bool parseString(std::string string, std::string type = "");
+	// Parses the files concurrently and merges their modules into one
+	// circuit, named after the first file's circuit. Modules defined in
+	// several files must be identical.
+	bool parseFiles(std::vector<std::string> filenames,
+			std::string type = "");
+	bool parseString(const std::string &string, std::string type = "");
 
 	void elaborate();
 
+	typedef struct {
+		uint64_t registers;
+		uint64_t regBits;
+		uint64_t memories;
+		uint64_t memoryBits;
+		uint64_t nodes;
+		uint64_t instances;
+	} HierarchyCounts;
+
+	typedef struct {
+		std::string name;
+		// Instances of the module in the flattened design
+		uint64_t count;
+		// The module's own statements
+		HierarchyCounts local;
+		// One instance of the module with everything below it
+		HierarchyCounts total;
+	} ModuleStatistics;
+
+	// Statistics of all modules, every module before the modules it
+	// instantiates
+	std::vector<ModuleStatistics> getHierarchyStatistics();
+
 	typedef struct {
 		std::string name;
 		std::string description;
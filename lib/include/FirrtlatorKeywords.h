@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "IR.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace Firrtlator {
+namespace Keywords {
+
+/*
+ * Keywords and primitive operations of FIRRTL, looked up with a perfect
+ * hash. The hash table is built by the compiler from the list of entries
+ * below and a static_assert checks that no two entries collide, so that a
+ * lookup is a hash, one table access and one compare.
+ */
+
+typedef enum {
+	NONE, CIRCUIT, MODULE, EXTMODULE, INPUT, OUTPUT, PARAMETER, DEFNAME,
+	UINT, SINT, CLOCK, FLIP, WIRE, REG, MEM, INST, OF, NODE, WITH, RESET,
+	IS, INVALID, WHEN, ELSE, STOP, PRINTF, SKIP, MUX, VALIDIF, DATA_TYPE,
+	DEPTH, READ_LATENCY, WRITE_LATENCY, READ_UNDER_WRITE, READER, WRITER,
+	READWRITER, OLD, NEW, UNDEFINED, PRIMOP
+} Keyword;
+
+struct Entry {
+	const char *name;
+	size_t length;
+	Keyword keyword;
+	PrimOp::Operation op;
+};
+
+template <size_t N>
+constexpr Entry keyword(const char (&name)[N], Keyword k) {
+	return Entry{name, N - 1, k, PrimOp::UNDEFINED};
+}
+
+template <size_t N>
+constexpr Entry primop(const char (&name)[N], PrimOp::Operation op) {
+	return Entry{name, N - 1, PRIMOP, op};
+}
+
+constexpr Entry entries[] = {
+	keyword("circuit", CIRCUIT), keyword("module", MODULE),
+	keyword("extmodule", EXTMODULE), keyword("input", INPUT),
+	keyword("output", OUTPUT), keyword("parameter", PARAMETER),
+	keyword("defname", DEFNAME), keyword("UInt", UINT),
+	keyword("SInt", SINT), keyword("Clock", CLOCK), keyword("flip", FLIP),
+	keyword("wire", WIRE), keyword("reg", REG), keyword("mem", MEM),
+	keyword("inst", INST), keyword("of", OF), keyword("node", NODE),
+	keyword("with", WITH), keyword("reset", RESET), keyword("is", IS),
+	keyword("invalid", INVALID), keyword("when", WHEN),
+	keyword("else", ELSE), keyword("stop", STOP),
+	keyword("printf", PRINTF), keyword("skip", SKIP),
+	keyword("mux", MUX), keyword("validif", VALIDIF),
+	keyword("data-type", DATA_TYPE), keyword("datatype", DATA_TYPE),
+	keyword("depth", DEPTH), keyword("read-latency", READ_LATENCY),
+	keyword("write-latency", WRITE_LATENCY),
+	keyword("read-under-write", READ_UNDER_WRITE),
+	keyword("reader", READER), keyword("writer", WRITER),
+	keyword("readwriter", READWRITER), keyword("old", OLD),
+	keyword("new", NEW), keyword("undefined", UNDEFINED),
+
+	primop("add", PrimOp::ADD), primop("sub", PrimOp::SUB),
+	primop("mul", PrimOp::MUL), primop("div", PrimOp::DIV),
+	primop("mod", PrimOp::MOD), primop("lt", PrimOp::LT),
+	primop("leq", PrimOp::LEQ), primop("gt", PrimOp::GT),
+	primop("geq", PrimOp::GEQ), primop("eq", PrimOp::EQ),
+	primop("neq", PrimOp::NEQ), primop("pad", PrimOp::PAD),
+	primop("asUInt", PrimOp::ASUINT), primop("asSInt", PrimOp::ASSINT),
+	primop("asClock", PrimOp::ASCLOCK), primop("shl", PrimOp::SHL),
+	primop("shr", PrimOp::SHR), primop("dshl", PrimOp::DSHL),
+	primop("dshr", PrimOp::DSHR), primop("cvt", PrimOp::CVT),
+	primop("neg", PrimOp::NEG), primop("not", PrimOp::NOT),
+	primop("and", PrimOp::AND), primop("or", PrimOp::OR),
+	primop("xor", PrimOp::XOR), primop("andr", PrimOp::ANDR),
+	primop("orr", PrimOp::ORR), primop("xorr", PrimOp::XORR),
+	primop("cat", PrimOp::CAT), primop("bits", PrimOp::BITS),
+	primop("head", PrimOp::HEAD), primop("tail", PrimOp::TAIL)
+};
+
+constexpr size_t numEntries = sizeof(entries) / sizeof(entries[0]);
+constexpr size_t tableSize = 256;
+constexpr uint8_t empty = 0xff;
+
+static_assert(numEntries < empty, "Too many keywords for the table");
+
+// Mixes the length and the characters 0, 1, 2, n-2 and n-1, which tell
+// all entries apart. The multiplier was chosen to avoid collisions.
+constexpr uint32_t mix(uint32_t h, unsigned char c) {
+	return h * 57291u + c;
+}
+
+constexpr uint32_t fold(uint32_t h) {
+	return (h ^ (h >> 15)) % tableSize;
+}
+
+constexpr size_t hash(const char *s, size_t len) {
+	return fold(mix(mix(mix(mix(mix(len, s[0]), s[1]),
+			(len > 2) ? s[2] : 0), s[len - 2]), s[len - 1]));
+}
+
+constexpr size_t larger(size_t a, size_t b) {
+	return (a > b) ? a : b;
+}
+
+constexpr size_t longest(size_t i = 0) {
+	return (i == numEntries) ? 0 :
+			larger(entries[i].length, longest(i + 1));
+}
+
+constexpr size_t maxLength = longest();
+
+// The first entry that hashes to the slot
+constexpr uint8_t slot(size_t h, size_t i = 0) {
+	return (i == numEntries) ? empty :
+			((hash(entries[i].name, entries[i].length) == h) ?
+					i : slot(h, i + 1));
+}
+
+constexpr bool collisionFree(size_t i = 0) {
+	return (i == numEntries) ||
+			((slot(hash(entries[i].name, entries[i].length)) == i)
+					&& collisionFree(i + 1));
+}
+
+static_assert(collisionFree(), "Keyword hash has collisions");
+
+template <size_t... I> struct Indices {};
+
+template <size_t N, size_t... I>
+struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+
+template <size_t... I>
+struct MakeIndices<0, I...> { typedef Indices<I...> type; };
+
+template <typename T> struct Table;
+
+template <size_t... I>
+struct Table<Indices<I...> > {
+	static constexpr uint8_t slots[sizeof...(I)] = { slot(I)... };
+};
+
+template <size_t... I>
+constexpr uint8_t Table<Indices<I...> >::slots[sizeof...(I)];
+
+typedef Table<MakeIndices<tableSize>::type> Slots;
+
+// Returns the entry for the word in [s, s+len) or nullptr
+inline const Entry *lookup(const char *s, size_t len) {
+	if ((len < 2) || (len > maxLength))
+		return nullptr;
+
+	uint8_t i = Slots::slots[hash(s, len)];
+	if (i == empty)
+		return nullptr;
+
+	const Entry *e = &entries[i];
+	if ((e->length != len) || (memcmp(e->name, s, len) != 0))
+		return nullptr;
+
+	return e;
+}
+
+// Spelling of a keyword, for error messages
+inline const char *name(Keyword k) {
+	for (size_t i = 0; i < numEntries; i++)
+		if (entries[i].keyword == k)
+			return entries[i].name;
+	return "";
+}
+
+}
+}
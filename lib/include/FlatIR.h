@@ -0,0 +1,428 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "IR.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Firrtlator {
+
+/*
+ * Compact copy of a circuit for passes that walk large designs. Instead of
+ * one object per node, every node kind has a table with one column per
+ * field, and nodes refer to each other by 32 bit handles that hold the
+ * kind and the row. Names and format strings are interned in a table of
+ * the circuit, locators are shared with the IR. Child lists are stored as
+ * ranges of one shared list, so the children of a node are contiguous.
+ *
+ * The columns are public for passes that work on the flat form. Converting
+ * a circuit and back with toIR() gives the same tree, except that
+ * references are not resolved and lazily parsed modules are loaded.
+ */
+class
+__attribute__ ((visibility ("default")))
+FlatCircuit {
+public:
+	typedef uint32_t Handle;
+
+	// Missing child, name or locator
+	static const uint32_t none = 0xffffffff;
+
+	struct Range {
+		uint32_t begin;
+		uint32_t size;
+	};
+
+	static Handle handle(NodeKind kind, uint32_t row) {
+		return ((uint32_t) kind << 27) | row;
+	}
+
+	static NodeKind kind(Handle h) {
+		return (NodeKind) (h >> 27);
+	}
+
+	static uint32_t row(Handle h) {
+		return h & ((1 << 27) - 1);
+	}
+
+	// Columns of all kinds, the locator is an index into the locators
+	struct Table {
+		std::vector<uint32_t> info;
+
+		size_t size() const { return info.size(); }
+	};
+
+	// Columns of the declarations, the name is an index into the strings
+	struct NamedTable : Table {
+		std::vector<uint32_t> name;
+	};
+
+	struct CircuitRow {
+		uint32_t name;
+		uint32_t info;
+		Range modules;
+	};
+
+	struct ModuleTable : NamedTable {
+		std::vector<uint8_t> external;
+		std::vector<uint32_t> defname;
+		std::vector<Range> ports;
+		std::vector<Range> parameters;
+		std::vector<Handle> stmts;
+	};
+
+	struct PortTable : NamedTable {
+		std::vector<uint8_t> output;
+		std::vector<Handle> type;
+	};
+
+	struct FieldTable : NamedTable {
+		std::vector<uint8_t> flip;
+		std::vector<Handle> type;
+	};
+
+	struct ConditionalElseTable : Table {
+		std::vector<Handle> stmts;
+	};
+
+	struct TypeIntTable : Table {
+		std::vector<int32_t> width;
+		std::vector<uint8_t> sign;
+	};
+
+	struct TypeBundleTable : Table {
+		std::vector<Range> fields;
+	};
+
+	struct TypeVectorTable : Table {
+		std::vector<Handle> type;
+		std::vector<int32_t> size;
+	};
+
+	struct StmtGroupTable : Table {
+		std::vector<Range> stmts;
+	};
+
+	struct WireTable : NamedTable {
+		std::vector<Handle> type;
+	};
+
+	struct RegTable : NamedTable {
+		std::vector<Handle> type;
+		std::vector<Handle> clock;
+		std::vector<Handle> resetTrigger;
+		std::vector<Handle> resetValue;
+	};
+
+	// The port name lists are ranges of the string lists
+	struct MemoryTable : NamedTable {
+		std::vector<Handle> dtype;
+		std::vector<int32_t> depth;
+		std::vector<int32_t> readLatency;
+		std::vector<int32_t> writeLatency;
+		std::vector<uint8_t> ruw;
+		std::vector<Range> readers;
+		std::vector<Range> writers;
+		std::vector<Range> readWriters;
+	};
+
+	struct InstanceTable : NamedTable {
+		std::vector<Handle> of;
+	};
+
+	struct NodeTable : NamedTable {
+		std::vector<Handle> expr;
+	};
+
+	struct ConnectTable : Table {
+		std::vector<Handle> to;
+		std::vector<Handle> from;
+		std::vector<uint8_t> partial;
+	};
+
+	struct InvalidTable : Table {
+		std::vector<Handle> expr;
+	};
+
+	struct ConditionalTable : Table {
+		std::vector<Handle> cond;
+		std::vector<Handle> then;
+		std::vector<Handle> otherwise;
+	};
+
+	struct StopTable : Table {
+		std::vector<Handle> clock;
+		std::vector<Handle> cond;
+		std::vector<int32_t> code;
+	};
+
+	struct PrintfTable : Table {
+		std::vector<Handle> clock;
+		std::vector<Handle> cond;
+		std::vector<uint32_t> format;
+		std::vector<Range> arguments;
+	};
+
+	struct ReferenceTable : Table {
+		std::vector<uint32_t> to;
+	};
+
+	struct ConstantTable : Table {
+		std::vector<Handle> type;
+		std::vector<uint32_t> literal;
+		std::vector<uint8_t> hint;
+	};
+
+	struct SubFieldTable : Table {
+		std::vector<Handle> of;
+		std::vector<Handle> field;
+	};
+
+	struct SubIndexTable : Table {
+		std::vector<Handle> of;
+		std::vector<int32_t> index;
+	};
+
+	struct SubAccessTable : Table {
+		std::vector<Handle> of;
+		std::vector<Handle> expr;
+	};
+
+	struct MuxTable : Table {
+		std::vector<Handle> sel;
+		std::vector<Handle> a;
+		std::vector<Handle> b;
+	};
+
+	struct CondValidTable : Table {
+		std::vector<Handle> sel;
+		std::vector<Handle> a;
+	};
+
+	// The parameters are ranges of the integer lists
+	struct PrimOpTable : Table {
+		std::vector<uint8_t> op;
+		std::vector<Range> operands;
+		std::vector<Range> parameters;
+	};
+
+	// Throws std::runtime_error if a kind has more rows than handles fit
+	FlatCircuit(std::shared_ptr<Circuit> ir);
+	FlatCircuit(const FlatCircuit&) = delete;
+	FlatCircuit& operator=(const FlatCircuit&) = delete;
+
+	// Builds the tree in a new arena
+	std::shared_ptr<Circuit> toIR() const;
+
+	Symbol getString(uint32_t index) const { return strings[index]; }
+	std::shared_ptr<Info> getInfo(Handle h) const;
+	// Empty for the kinds that have no name
+	Symbol getName(Handle h) const;
+
+	const Handle *begin(Range r) const { return lists.data() + r.begin; }
+	const Handle *end(Range r) const { return begin(r) + r.size; }
+
+	// Calls f with the children of the node in the order of the IR
+	template <typename F>
+	void forEachChild(Handle h, F f) const;
+
+	// Calls f on the node and the nodes below it in pre-order, returning
+	// false from f skips the children. Does not recurse.
+	template <typename F>
+	void walk(Handle root, F f) const;
+
+	size_t getNodeCount() const;
+	// Bytes of the tables and lists, without the strings and locators
+	// that are shared with the IR
+	size_t getMemoryUsage() const;
+
+	CircuitRow circuit;
+	ModuleTable modules;
+	PortTable ports;
+	Table parameters;
+	FieldTable fields;
+	ConditionalElseTable conditionalElses;
+	TypeIntTable typeInts;
+	Table typeClocks;
+	TypeBundleTable typeBundles;
+	TypeVectorTable typeVectors;
+	StmtGroupTable stmtGroups;
+	WireTable wires;
+	RegTable regs;
+	MemoryTable memories;
+	InstanceTable instances;
+	NodeTable nodes;
+	ConnectTable connects;
+	InvalidTable invalids;
+	ConditionalTable conditionals;
+	StopTable stops;
+	PrintfTable printfs;
+	Table empties;
+	ReferenceTable references;
+	ConstantTable constants;
+	SubFieldTable subFields;
+	SubIndexTable subIndices;
+	SubAccessTable subAccesses;
+	MuxTable muxes;
+	CondValidTable condValids;
+	PrimOpTable primOps;
+
+	std::vector<Symbol> strings;
+	std::vector<std::shared_ptr<Info> > infos;
+	std::vector<Handle> lists;
+	std::vector<uint32_t> stringLists;
+	std::vector<int32_t> intLists;
+private:
+	// The table of each kind, and of each kind with a name
+	Table *mTables[(size_t) NodeKind::PrimOp + 1];
+	NamedTable *mNamedTables[(size_t) NodeKind::PrimOp + 1];
+};
+
+template <typename F>
+void FlatCircuit::forEachChild(Handle h, F f) const {
+	uint32_t r = row(h);
+
+	auto optional = [&f] (Handle c) {
+		if (c != none)
+			f(c);
+	};
+	auto all = [this, &f] (Range l) {
+		for (const Handle *c = begin(l); c != end(l); ++c)
+			f(*c);
+	};
+
+	switch (kind(h)) {
+	case NodeKind::Module:
+		all(modules.ports[r]);
+		all(modules.parameters[r]);
+		optional(modules.stmts[r]);
+		return;
+	case NodeKind::Port:
+		f(ports.type[r]);
+		return;
+	case NodeKind::Field:
+		f(fields.type[r]);
+		return;
+	case NodeKind::ConditionalElse:
+		optional(conditionalElses.stmts[r]);
+		return;
+	case NodeKind::TypeBundle:
+		all(typeBundles.fields[r]);
+		return;
+	case NodeKind::TypeVector:
+		optional(typeVectors.type[r]);
+		return;
+	case NodeKind::StmtGroup:
+		all(stmtGroups.stmts[r]);
+		return;
+	case NodeKind::Wire:
+		f(wires.type[r]);
+		return;
+	case NodeKind::Reg:
+		f(regs.type[r]);
+		f(regs.clock[r]);
+		optional(regs.resetTrigger[r]);
+		optional(regs.resetValue[r]);
+		return;
+	case NodeKind::Memory:
+		optional(memories.dtype[r]);
+		return;
+	case NodeKind::Instance:
+		f(instances.of[r]);
+		return;
+	case NodeKind::Node:
+		f(nodes.expr[r]);
+		return;
+	case NodeKind::Connect:
+		f(connects.to[r]);
+		f(connects.from[r]);
+		return;
+	case NodeKind::Invalid:
+		f(invalids.expr[r]);
+		return;
+	case NodeKind::Conditional:
+		f(conditionals.cond[r]);
+		optional(conditionals.then[r]);
+		optional(conditionals.otherwise[r]);
+		return;
+	case NodeKind::Stop:
+		f(stops.clock[r]);
+		f(stops.cond[r]);
+		return;
+	case NodeKind::Printf:
+		f(printfs.clock[r]);
+		f(printfs.cond[r]);
+		all(printfs.arguments[r]);
+		return;
+	case NodeKind::Constant:
+		optional(constants.type[r]);
+		return;
+	case NodeKind::SubField:
+		f(subFields.of[r]);
+		f(subFields.field[r]);
+		return;
+	case NodeKind::SubIndex:
+		f(subIndices.of[r]);
+		return;
+	case NodeKind::SubAccess:
+		f(subAccesses.of[r]);
+		f(subAccesses.expr[r]);
+		return;
+	case NodeKind::Mux:
+		f(muxes.sel[r]);
+		f(muxes.a[r]);
+		f(muxes.b[r]);
+		return;
+	case NodeKind::CondValid:
+		f(condValids.sel[r]);
+		f(condValids.a[r]);
+		return;
+	case NodeKind::PrimOp:
+		all(primOps.operands[r]);
+		return;
+	default:
+		return;
+	}
+}
+
+template <typename F>
+void FlatCircuit::walk(Handle root, F f) const {
+	std::vector<Handle> stack(1, root);
+
+	while (!stack.empty()) {
+		Handle h = stack.back();
+		stack.pop_back();
+
+		if (!f(h))
+			continue;
+
+		// The children are pushed last first to be visited in order
+		size_t top = stack.size();
+		forEachChild(h, [&stack] (Handle c) { stack.push_back(c); });
+		std::reverse(stack.begin() + top, stack.end());
+	}
+}
+
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "IR.h"
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace Firrtlator {
+
+/*
+ * Module-level instance graph of a circuit. Each module is a vertex with
+ * an edge to every module it instantiates, weighted by the number of
+ * instances. As the graph is a DAG, the flattened instance counts and the
+ * statistics of whole subtrees are computed once per module over the
+ * topological order, without expanding the instance tree.
+ */
+class
+__attribute__ ((visibility ("default")))
+Hierarchy {
+public:
+	struct Statistics {
+		uint64_t registers;
+		uint64_t regBits;
+		uint64_t memories;
+		uint64_t memoryBits;
+		uint64_t nodes;
+		uint64_t instances;
+	};
+
+	// Throws std::runtime_error if the instances form a cycle
+	Hierarchy(std::shared_ptr<Circuit> circuit);
+
+	// Modules in topological order, every module before the modules it
+	// instantiates
+	const std::vector<std::shared_ptr<Module> > &getOrder();
+
+	// The module named like the circuit, or nullptr
+	std::shared_ptr<Module> getTop();
+
+	// Number of instances of the module in the flattened top module, or
+	// in all modules that are not instantiated if there is no top
+	uint64_t getInstanceCount(std::shared_ptr<Module> module);
+	// Statistics of the module's own statements
+	Statistics getLocal(std::shared_ptr<Module> module);
+	// Statistics of one instance of the module and all below it
+	Statistics getTotal(std::shared_ptr<Module> module);
+private:
+	struct Vertex {
+		std::shared_ptr<Module> module;
+		// Instantiated modules and the number of instances of each
+		std::vector<std::pair<size_t, uint64_t> > children;
+		Statistics local;
+		Statistics total;
+		uint64_t count;
+	};
+
+	std::vector<Vertex> mVertices;
+	std::unordered_map<const Module*, size_t> mIndex;
+	std::vector<std::shared_ptr<Module> > mOrder;
+	std::shared_ptr<Module> mTop;
+
+	Vertex &vertex(std::shared_ptr<Module> module);
+};
+
+}
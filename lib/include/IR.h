@@ -23,12 +23,19 @@
 #pragma once
 
 #include "Util.h"
+#include "Symbol.h"
+#include "BitVector.h"
+#include "Arena.h"
 
 #include <string>
 #include <memory>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <algorithm>
+#include <functional>
+#include <ostream>
+#include <cstdint>
 
 namespace Firrtlator {
 
@@ -41,33 +48,90 @@ class StmtGroup;
 class Expression;
 class Type;
 class Visitor;
+class RefVisitor;
+template <typename Derived> class StaticVisitor;
 
+/*
+ * The kind of an IR node, as tested by isa<>(), cast<>() and dyn_cast<>()
+ * and switched on by the StaticVisitor. The kinds of the types, the
+ * statements and the expressions are contiguous ranges.
+ */
+enum class NodeKind : uint8_t {
+	Circuit, Module, Port, Parameter, Field, ConditionalElse,
+	TypeInt, TypeClock, TypeBundle, TypeVector,
+	StmtGroup, Wire, Reg, Memory, Instance, Node, Connect, Invalid,
+	Conditional, Stop, Printf, Empty,
+	Reference, Constant, SubField, SubIndex, SubAccess, Mux, CondValid,
+	PrimOp
+};
+
+/*
+ * Source locator. Locators of the form "<file> <line>:<column>" are stored
+ * as the interned file name and the two numbers, all other locators keep
+ * their text. getValue() and print() return the original text.
+ */
 class Info {
 private:
-	std::string mValue;
+	Symbol mText;
+	uint32_t mLine;
+	uint32_t mColumn : 31;
+	uint32_t mLocation : 1;
+
+	void parse(const char *begin, const char *end);
 public:
 	Info(std::string value = "");
+	Info(const char *begin, const char *end);
+	Info(Symbol file, unsigned line, unsigned column);
+
 	void setValue(std::string value);
-	std::string getValue();
+	std::string getValue() const;
+	void print(std::ostream &os) const;
+
+	bool isLocation() const { return mLocation; }
+	Symbol getFile() const { return mLocation ? mText : Symbol(); }
+	unsigned getLine() const { return mLine; }
+	unsigned getColumn() const { return mColumn; }
+
+	bool operator==(const Info &other) const;
+	size_t hash() const;
+
 	friend std::ostream& operator<< (std::ostream &out, const Info &Info);
 };
 
 class IRNode : public std::enable_shared_from_this<IRNode> {
 public:
 	virtual ~IRNode();
-	IRNode();
-	IRNode(std::string id);
-	std::string getId();
-	void setId(std::string id);
+	IRNode(NodeKind kind);
+	IRNode(NodeKind kind, Symbol id);
+	NodeKind getKind() const { return mKind; }
+	const std::string &getId();
+	Symbol getSymbol();
+	void setId(Symbol id);
 	std::shared_ptr<Info> getInfo();
 	void setInfo(std::shared_ptr<Info> info);
 	bool isDeclaration();
-	virtual void accept(Visitor& v) = 0;
+	// Walks the tree below this node, see walk()
+	void accept(Visitor& v);
+	void accept(RefVisitor& v);
 protected:
 	std::shared_ptr<Info> mInfo;
-	std::string mId;
+	Symbol mId;
+	NodeKind mKind;
 	std::vector<std::shared_ptr<IRNode> > mReferences;
 
+	// Destructors of nodes with children release them with these, so
+	// deep trees are destroyed in a loop instead of recursively
+	template <typename T>
+	static void release(std::shared_ptr<T> &node) {
+		defer(std::move(node));
+	}
+	template <typename T>
+	static void release(std::vector<std::shared_ptr<T> > &nodes) {
+		for (auto &n : nodes)
+			defer(std::move(n));
+	}
+	static void defer(std::shared_ptr<IRNode> node);
+
     template <typename Derived>
     std::shared_ptr<Derived> shared_from_base()
     {
@@ -77,31 +141,98 @@ protected:
 
 std::ostream& operator<< (std::ostream& os, const ::Firrtlator::IRNode& n);
 
+/*
+ * Casts on the node kind in the style of LLVM: isa<T>() tests the kind,
+ * cast<T>() throws on a mismatch and dyn_cast<T>() returns null.
+ */
+template <typename T>
+inline bool isa(const IRNode *n) {
+	return T::classof(n);
+}
+
+template <typename T>
+inline bool isa(const IRNode &n) {
+	return T::classof(&n);
+}
+
+template <typename T, typename U>
+inline bool isa(const std::shared_ptr<U> &n) {
+	return T::classof(n.get());
+}
+
+template <typename T>
+inline T *cast(IRNode *n) {
+	if (!isa<T>(n))
+		throw std::runtime_error("Invalid cast of IR node");
+	return static_cast<T*>(n);
+}
+
+template <typename T>
+inline T &cast(IRNode &n) {
+	return *cast<T>(&n);
+}
+
+template <typename T, typename U>
+inline std::shared_ptr<T> cast(const std::shared_ptr<U> &n) {
+	cast<T>(n.get());
+	return std::static_pointer_cast<T>(n);
+}
+
+template <typename T>
+inline T *dyn_cast(IRNode *n) {
+	return isa<T>(n) ? static_cast<T*>(n) : nullptr;
+}
+
+template <typename T, typename U>
+inline std::shared_ptr<T> dyn_cast(const std::shared_ptr<U> &n) {
+	return isa<T>(n) ? std::static_pointer_cast<T>(n) : nullptr;
+}
+
 class Circuit : public IRNode {
 public:
 	Circuit();
-	Circuit(std::string id);
-	Circuit(std::string id, std::shared_ptr<Info> info);
+	Circuit(Symbol id);
+	Circuit(Symbol id, std::shared_ptr<Info> info);
 
 	void addModule(std::shared_ptr<Module> mod);
-	std::vector<std::shared_ptr<Module> > getModules();
-
-	virtual void accept(Visitor& v);
+	const std::vector<std::shared_ptr<Module> > &getModules();
+	// Replaces all modules
+	void setModules(const std::vector<std::shared_ptr<Module> > &modules);
+	// Returns the module with the name, or nullptr if there is none
+	std::shared_ptr<Module> getModule(Symbol id);
+
+	// Arena for the nodes of this circuit
+	void setArena(std::shared_ptr<Arena> arena);
+	std::shared_ptr<Arena> getArena();
+
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::Circuit;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	std::vector<std::shared_ptr<Module> > mModules;
 	std::vector<std::shared_ptr<Module> > mExternalModules;
 	std::vector<std::shared_ptr<Module> > mInternalModules;
+	std::unordered_map<Symbol, std::shared_ptr<Module> > mModuleIndex;
+	std::shared_ptr<Arena> mArena;
 };
 
 class Port : public IRNode {
 public:
 	typedef enum { INPUT, OUTPUT } Direction;
 	Port();
-	Port(std::string id, Direction dir, std::shared_ptr<Type> type);
+	Port(Symbol id, Direction dir, std::shared_ptr<Type> type);
 	void setDirection(Direction dir);
 	Direction getDirection();
-	virtual void accept(Visitor& v);
+	std::shared_ptr<Type> getType();
+
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::Port;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	Direction mDirection;
 	std::shared_ptr<Type> mType;
 };
@@ -109,9 +240,14 @@ private:
 class Type : public IRNode {
 public:
 	typedef enum { INT, CLOCK, BUNDLE, VECTOR, UNDEFINED } Basetype;
-	Type();
-	Type(Basetype type);
-	virtual void accept(Visitor& v) = 0;
+	Type(NodeKind kind);
+	Type(NodeKind kind, Basetype type);
+	Basetype getBasetype();
+
+	static bool classof(const IRNode *n) {
+		return n->getKind() >= NodeKind::TypeInt &&
+				n->getKind() <= NodeKind::TypeVector;
+	}
 protected:
 	Basetype mBasetype;
 };
@@ -126,7 +262,10 @@ public:
 
 	bool getSigned();
 	void setSigned(bool sign);
-	virtual void accept(Visitor& v);
+
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::TypeInt;
+	}
 private:
 	int mWidth;
 	bool mSigned;
@@ -135,21 +274,29 @@ private:
 class TypeClock : public Type {
 public:
 	TypeClock();
-	virtual void accept(Visitor& v);
+
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::TypeClock;
+	}
 };
 
 class Field : public IRNode {
 public:
 	Field();
-	Field(std::string id, std::shared_ptr<Type> type, bool flip = false);
+	Field(Symbol id, std::shared_ptr<Type> type, bool flip = false);
+	virtual ~Field();
 
 	void setType(std::shared_ptr<Type> t);
 	std::shared_ptr<Type> getType();
 	void setFlip(bool flip);
 	bool getFlip();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::Field;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	bool mFlip;
 	std::shared_ptr<Type> mType;
 };
@@ -157,24 +304,37 @@ private:
 class TypeBundle : public Type {
 public:
 	TypeBundle();
+	virtual ~TypeBundle();
 
 	void addField(std::shared_ptr<Field> field);
-	std::vector<std::shared_ptr<Field> > getFields();
+	const std::vector<std::shared_ptr<Field> > &getFields();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::TypeBundle;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	std::vector<std::shared_ptr<Field> > mFields;
 };
 
 class TypeVector : public Type {
 public:
 	TypeVector();
+	TypeVector(std::shared_ptr<Type> type, int size);
+	virtual ~TypeVector();
 
+	void setType(std::shared_ptr<Type> type);
+	std::shared_ptr<Type> getType();
 	void setSize(int size);
 	int getSize();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::TypeVector;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	std::shared_ptr<Type> mType;
 	int mSize;
 };
@@ -182,39 +342,54 @@ private:
 class Parameter : public IRNode {
 public:
 	Parameter();
-	virtual void accept(Visitor& v);
+
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::Parameter;
+	}
 };
 
 class Module : public IRNode {
 public:
 	Module();
-	Module(std::string id, bool external = false);
+	Module(Symbol id, bool external = false);
 
 	void addPort(std::shared_ptr<Port> port);
 	void setStatementGroup(std::shared_ptr<StmtGroup> stmt);
+	// The statements are generated by the loader on first access
+	void setStatementLoader(std::function<std::shared_ptr<StmtGroup>()> loader);
+	bool isLoaded();
 	void setDefname(std::string defname);
 	void addParameter(std::shared_ptr<Parameter> param);
 
 	bool isExternal();
 	std::string getDefname();
-	std::vector<std::shared_ptr<Port> > getPorts();
+	const std::vector<std::shared_ptr<Port> > &getPorts();
 	std::shared_ptr<StmtGroup> getStmts();
-	std::vector<std::shared_ptr<Parameter> > getParameters();
+	const std::vector<std::shared_ptr<Parameter> > &getParameters();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::Module;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	bool mExternal;
 	std::string mDefname;
 	std::vector<std::shared_ptr<Port> > mPorts;
 	std::shared_ptr<StmtGroup> mStmts;
+	std::function<std::shared_ptr<StmtGroup>()> mLoader;
 	std::vector<std::shared_ptr<Parameter> > mParameters;
 };
 
 class Stmt : public IRNode {
 public:
-	Stmt();
-	Stmt(std::string id);
-	virtual void accept(Visitor& v) = 0;
+	Stmt(NodeKind kind);
+	Stmt(NodeKind kind, Symbol id);
+
+	static bool classof(const IRNode *n) {
+		return n->getKind() >= NodeKind::StmtGroup &&
+				n->getKind() <= NodeKind::Empty;
+	}
 };
 
 class StmtGroup : public Stmt {
@@ -222,6 +397,7 @@ public:
 	StmtGroup();
 	StmtGroup(std::shared_ptr<Stmt> stmt);
 	StmtGroup(std::vector<std::shared_ptr<Stmt> > group);
+	virtual ~StmtGroup();
 
 	void addStatement(std::shared_ptr<Stmt> stmt);
 
@@ -230,29 +406,41 @@ public:
 	iterator begin();
 	iterator end();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::StmtGroup;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	std::vector<std::shared_ptr<Stmt> > mGroup;
 };
 
 class Wire : public Stmt {
 public:
 	Wire();
-	Wire(std::string id, std::shared_ptr<Type> type);
+	Wire(Symbol id, std::shared_ptr<Type> type);
 
 	std::shared_ptr<Type> getType();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::Wire;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	std::shared_ptr<Type> mType;
 };
 
 class Reg : public Stmt {
 public:
 	Reg();
-	Reg(std::string id, std::shared_ptr<Type> type,
+	Reg(Symbol id, std::shared_ptr<Type> type,
 			std::shared_ptr<Expression> clock);
-	virtual void accept(Visitor& v);
+
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::Reg;
+	}
+
 	std::shared_ptr<Type> getType();
 	std::shared_ptr<Expression> getClock();
 	void setResetTrigger(std::shared_ptr<Expression> trigger);
@@ -260,6 +448,8 @@ public:
 	std::shared_ptr<Expression> getResetTrigger();
 	std::shared_ptr<Expression> getResetValue();
 private:
+	template <typename> friend class StaticVisitor;
+
 	std::shared_ptr<Type> mType;
 	std::shared_ptr<Expression> mClock;
 	std::shared_ptr<Expression> mResetTrigger;
@@ -269,7 +459,7 @@ private:
 class Memory : public Stmt {
 public:
 	typedef enum { OLD, NEW, UNDEFINED } RuwFlag;
-	Memory(std::string id);
+	Memory(Symbol id);
 	void setDType(std::shared_ptr<Type> type);
 	void setDepth(int depth);
 	void setReadLatency(int lat);
@@ -281,15 +471,17 @@ public:
 
 	std::shared_ptr<Type> getDType();
 	std::shared_ptr<TypeBundle> getType();
-	std::vector<std::string> getReaders();
-	std::vector<std::string> getWriters();
-	std::vector<std::string> getReadWriters();
+	const std::vector<std::string> &getReaders();
+	const std::vector<std::string> &getWriters();
+	const std::vector<std::string> &getReadWriters();
 	int getDepth();
 	int getReadlatency();
 	int getWritelatency();
 	RuwFlag getRuwflag();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::Memory;
+	}
 protected:
 	std::shared_ptr<Type> mDType = nullptr;
 	std::shared_ptr<TypeBundle> mType = nullptr;
@@ -311,24 +503,34 @@ protected:
 class Instance : public Stmt {
 public:
 	Instance();
-	Instance(std::string id, std::shared_ptr<Reference> of);
+	Instance(Symbol id, std::shared_ptr<Reference> of);
 
 	std::shared_ptr<Reference> getOf();
+	// The instantiated module once elaborated, nullptr before
+	std::shared_ptr<Module> getModule();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::Instance;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	std::shared_ptr<Reference> mOf;
 };
 
 class Node : public Stmt {
 public:
 	Node();
-	Node(std::string id, std::shared_ptr<Expression> expr);
+	Node(Symbol id, std::shared_ptr<Expression> expr);
 
 	std::shared_ptr<Expression> getExpression();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::Node;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	std::shared_ptr<Expression> mExpr;
 };
 
@@ -343,8 +545,12 @@ public:
 	std::shared_ptr<Expression> getTo();
 	std::shared_ptr<Expression> getFrom();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::Connect;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	std::shared_ptr<Expression> mTo;
 	std::shared_ptr<Expression> mFrom;
 	bool mPartial;
@@ -357,8 +563,12 @@ public:
 
 	std::shared_ptr<Expression> getExpr();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::Invalid;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	std::shared_ptr<Expression> mExp;
 };
 
@@ -368,6 +578,7 @@ class Conditional : public Stmt {
 public:
 	Conditional();
 	Conditional(std::shared_ptr<Expression> cond);
+	virtual ~Conditional();
 	void setThen(std::shared_ptr<StmtGroup> stmts);
 	void setElse(std::shared_ptr<ConditionalElse> stmt);
 
@@ -375,8 +586,12 @@ public:
 	std::shared_ptr<StmtGroup> getThen();
 	std::shared_ptr<ConditionalElse> getElse();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::Conditional;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	std::shared_ptr<Expression> mCond;
 	std::shared_ptr<StmtGroup> mThen;
 	std::shared_ptr<ConditionalElse> mElse;
@@ -386,17 +601,21 @@ class ConditionalElse : public IRNode {
 public:
 	ConditionalElse();
 	ConditionalElse(std::shared_ptr<StmtGroup> stmts);
+	virtual ~ConditionalElse();
 
 	void setStmts(std::shared_ptr<StmtGroup> stmts);
 
 	std::shared_ptr<StmtGroup> getStmts();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::ConditionalElse;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	std::shared_ptr<StmtGroup> mStmts;
 };
 
-
 class Stop : public Stmt {
 public:
 	Stop();
@@ -408,8 +627,12 @@ public:
 	std::shared_ptr<Expression> getCondition();
 	int getCode();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::Stop;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	std::shared_ptr<Expression> mClock;
 	std::shared_ptr<Expression> mCond;
 	int mCode;
@@ -426,10 +649,14 @@ public:
 	std::shared_ptr<Expression> getClock();
 	std::shared_ptr<Expression> getCondition();
 	std::string getFormat();
-	std::vector<std::shared_ptr<Expression> > getArguments();
+	const std::vector<std::shared_ptr<Expression> > &getArguments();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::Printf;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	std::shared_ptr<Expression> mClock;
 	std::shared_ptr<Expression> mCond;
 	std::string mFormat;
@@ -438,16 +665,24 @@ private:
 
 class Empty : public Stmt {
 public:
-	virtual void accept(Visitor& v);
+	Empty();
+
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::Empty;
+	}
 };
 
 class Expression : public IRNode {
 public:
 	typedef enum { MALE, FEMALE, BI } Gender;
-	Expression();
-	Expression(Gender g);
+	Expression(NodeKind kind);
+	Expression(NodeKind kind, Gender g);
 	Gender getGender();
-	virtual void accept(Visitor& v) = 0;
+
+	static bool classof(const IRNode *n) {
+		return n->getKind() >= NodeKind::Reference &&
+				n->getKind() <= NodeKind::PrimOp;
+	}
 private:
 	Gender mGender;
 };
@@ -455,15 +690,23 @@ private:
 class Reference : public Expression {
 public:
 	Reference();
-	Reference(std::string id);
+	Reference(Symbol id);
 
 	bool isResolved();
-	virtual std::string getToString();
+	virtual const std::string &getToString();
+	Symbol getToSymbol();
+
+	// The declaration referred to, set by elaboration. It is not owned,
+	// as declarations like registers may refer to themselves.
+	std::shared_ptr<IRNode> getTo();
+	void setTo(std::shared_ptr<IRNode> to);
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::Reference;
+	}
 private:
-	std::shared_ptr<IRNode> mTo;
-	std::string mToString;
+	std::weak_ptr<IRNode> mTo;
+	Symbol mToString;
 };
 
 class Constant : public Expression {
@@ -474,16 +717,27 @@ public:
 			GenerateHint hint = INT);
 	Constant(std::shared_ptr<TypeInt> type, std::string val,
 			GenerateHint hint = STRING);
+	// Parses the literal and keeps its text for the output
+	Constant(std::shared_ptr<TypeInt> type, Symbol literal,
+			GenerateHint hint);
+	Constant(std::shared_ptr<TypeInt> type, BitVector val,
+			GenerateHint hint = INT);
 
 	std::shared_ptr<TypeInt> getType();
-	int getValue();
+	const BitVector &getValue();
 	GenerateHint getHint();
+	// The literal as written in the input, or the value formatted
+	// according to the hint if the constant was not parsed
+	Symbol getLiteral();
 	std::string getString();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::Constant;
+	}
 private:
 	std::shared_ptr<TypeInt> mType;
-	int mVal;
+	BitVector mVal;
+	Symbol mLiteral;
 	GenerateHint mHint;
 };
 
@@ -491,12 +745,17 @@ class SubField : public Expression {
 public:
 	SubField();
 	SubField(std::shared_ptr<Reference> field, std::shared_ptr<Expression> of);
+	virtual ~SubField();
 
 	std::shared_ptr<Expression> getOf();
 	std::shared_ptr<Reference> getField();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::SubField;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	std::shared_ptr<Expression> mOf;
 	std::shared_ptr<Reference> mField;
 };
@@ -505,12 +764,17 @@ class SubIndex : public Expression {
 public:
 	SubIndex();
 	SubIndex(int index, std::shared_ptr<Expression> of);
+	virtual ~SubIndex();
 
 	std::shared_ptr<Expression> getOf();
 	int getIndex();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::SubIndex;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	std::shared_ptr<Expression> mOf;
 	int mIndex;
 };
@@ -518,14 +782,19 @@ private:
 class SubAccess : public Expression {
 public:
 	SubAccess();
+	virtual ~SubAccess();
 	SubAccess(std::shared_ptr<Expression> expr,
 			std::shared_ptr<Expression> of);
 
 	std::shared_ptr<Expression> getOf();
 	std::shared_ptr<Expression> getExp();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::SubAccess;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	std::shared_ptr<Expression> mOf;
 	std::shared_ptr<Expression> mExp;
 };
@@ -533,6 +802,7 @@ private:
 class Mux : public Expression {
 public:
 	Mux();
+	virtual ~Mux();
 	Mux(std::shared_ptr<Expression> sel, std::shared_ptr<Expression> a,
 			std::shared_ptr<Expression> b);
 
@@ -540,8 +810,12 @@ public:
 	std::shared_ptr<Expression> getA();
 	std::shared_ptr<Expression> getB();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::Mux;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	std::shared_ptr<Expression> mSel;
 	std::shared_ptr<Expression> mA;
 	std::shared_ptr<Expression> mB;
@@ -550,19 +824,23 @@ private:
 class CondValid : public Expression {
 public:
 	CondValid();
+	virtual ~CondValid();
 	CondValid(std::shared_ptr<Expression> sel,
 			std::shared_ptr<Expression> a);
 
 	std::shared_ptr<Expression> getSel();
 	std::shared_ptr<Expression> getA();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::CondValid;
+	}
 private:
+	template <typename> friend class StaticVisitor;
+
 	std::shared_ptr<Expression> mSel;
 	std::shared_ptr<Expression> mA;
 };
 
-
 class PrimOp : public Expression {
 public:
 	typedef enum {
@@ -573,9 +851,9 @@ public:
 
 	PrimOp();
 	PrimOp(Operation op, int numOp, int numParam);
-	virtual ~PrimOp() {}
+	virtual ~PrimOp();
 
-	static const bool lookup(std::string v, Operation &op);
+	static const bool lookup(const std::string &v, Operation &op);
 	std::string operationName();
 	static const std::string operationName(Operation op);
 
@@ -589,11 +867,15 @@ public:
 	int numParameters() {return mNumParameters; }
 
 	Operation getOp();
-	std::vector<std::shared_ptr<Expression> > getOperands();
-	std::vector<int> getParameters();
+	const std::vector<std::shared_ptr<Expression> > &getOperands();
+	const std::vector<int> &getParameters();
 
-	virtual void accept(Visitor& v);
+	static bool classof(const IRNode *n) {
+		return n->getKind() == NodeKind::PrimOp;
+	}
 protected:
+	template <typename> friend class StaticVisitor;
+
 	Operation mOp;
 	std::vector<std::shared_ptr<Expression> > mOperands;
 	std::vector<int> mParameters;
@@ -659,7 +941,7 @@ public:
 
 class PrimOpPAD : public PrimOp {
 public:
-	PrimOpPAD() : PrimOp(ADD, 1, 1) {}
+	PrimOpPAD() : PrimOp(PAD, 1, 1) {}
 };
 
 class PrimOpASUINT : public PrimOp {
@@ -714,7 +996,7 @@ public:
 
 class PrimOpAND : public PrimOp {
 public:
-	PrimOpAND() : PrimOp(ADD, 2, 0) {}
+	PrimOpAND() : PrimOp(AND, 2, 0) {}
 };
 
 class PrimOpOR : public PrimOp {
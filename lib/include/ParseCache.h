@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "IR.h"
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Firrtlator {
+
+/*
+ * On-disk cache of parsed circuits. An entry is a FIRB image keyed by a
+ * hash of the input bytes, the frontend and the library version, so a
+ * repeated parse of an unchanged input loads the image instead.
+ *
+ * Entries are written to a temporary file and renamed into place, which
+ * makes them appear atomically to other processes sharing the directory.
+ * When the directory grows beyond the size limit the least recently used
+ * entries are removed.
+ */
+class ParseCache {
+public:
+	struct Key {
+		uint64_t hash;
+		uint64_t size;
+		std::string frontend;
+	};
+
+	struct Statistics {
+		uint64_t hits;
+		uint64_t misses;
+		uint64_t stores;
+		uint64_t evictions;
+		uint64_t entries;
+		uint64_t bytes;
+	};
+
+	ParseCache(std::string directory, uint64_t limit = 0);
+
+	Key key(const char *buffer, size_t size, std::string frontend);
+
+	// Returns the mapped entry and sets the position of the image in it,
+	// or nullptr on a miss
+	std::shared_ptr<MappedFile> lookup(const Key &key, const char *&image,
+			size_t &size);
+	// Throws the parse errors of module bodies that are loaded to be stored
+	bool store(const Key &key, std::shared_ptr<Circuit> ir);
+	// Drops an entry that could not be loaded
+	void invalidate(const Key &key);
+
+	void hit();
+	void miss();
+
+	Statistics getStatistics();
+private:
+	struct Header {
+		char magic[4];
+		uint32_t version;
+		uint64_t hash;
+		uint64_t size;
+	};
+
+	std::string path(const Key &key);
+	void scan(bool evict);
+
+	std::string mDirectory;
+	uint64_t mLimit;
+	Statistics mStatistics;
+	std::mutex mMutex;
+};
+
+}
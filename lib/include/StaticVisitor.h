@@ -0,0 +1,549 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "IR.h"
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace Firrtlator {
+
+/*
+ * Visitor that is dispatched at compile time. The traversal switches on
+ * the node kind and calls the handlers of Derived directly, so they can be
+ * inlined and no virtual call is made. Handlers have the name of the node
+ * class, as in visitWire(Wire&) and leaveWire(Wire&), so that Derived only
+ * declares the ones it overrides. Returning false from visit skips the
+ * children and the leave handler.
+ *
+ * The walk does not recurse: visit is called in pre-order and leave in
+ * post-order from an explicit work stack, so the depth of the tree is only
+ * bound by memory. Handlers may call traverse() on a subtree themselves.
+ */
+template <typename Derived>
+class StaticVisitor {
+public:
+	StaticVisitor() : mTop(nullptr), mEnd(nullptr) {}
+
+	// The work stack is not shared with copies
+	StaticVisitor(const StaticVisitor&) : StaticVisitor() {}
+
+	StaticVisitor &operator=(const StaticVisitor&) {
+		return *this;
+	}
+
+	void traverse(IRNode &n);
+
+	template <typename T>
+	void traverse(const std::shared_ptr<T> &n) {
+		traverse(*n);
+	}
+
+	bool visitCircuit(Circuit&) { return true; }
+	void leaveCircuit(Circuit&) {}
+
+	bool visitModule(Module&) { return true; }
+	void leaveModule(Module&) {}
+
+	bool visitPort(Port&) { return true; }
+	void leavePort(Port&) {}
+
+	bool visitParameter(Parameter&) { return true; }
+
+	void visitTypeInt(TypeInt&) {}
+
+	void visitTypeClock(TypeClock&) {}
+
+	bool visitField(Field&) { return true; }
+	void leaveField(Field&) {}
+
+	bool visitTypeBundle(TypeBundle&) { return true; }
+	void leaveTypeBundle(TypeBundle&) {}
+
+	bool visitTypeVector(TypeVector&) { return true; }
+	void leaveTypeVector(TypeVector&) {}
+
+	bool visitStmtGroup(StmtGroup&) { return true; }
+	void leaveStmtGroup(StmtGroup&) {}
+
+	bool visitWire(Wire&) { return true; }
+	void leaveWire(Wire&) {}
+
+	bool visitReg(Reg&) { return true; }
+	void leaveReg(Reg&) {}
+
+	bool visitInstance(Instance&) { return true; }
+	void leaveInstance(Instance&) {}
+
+	bool visitMemory(Memory&) { return true; }
+
+	bool visitNode(Node&) { return true; }
+	void leaveNode(Node&) {}
+
+	bool visitConnect(Connect&) { return true; }
+	void leaveConnect(Connect&) {}
+
+	bool visitInvalid(Invalid&) { return true; }
+	void leaveInvalid(Invalid&) {}
+
+	bool visitConditional(Conditional&) { return true; }
+	void leaveConditional(Conditional&) {}
+
+	bool visitConditionalElse(ConditionalElse&) { return true; }
+	void leaveConditionalElse(ConditionalElse&) {}
+
+	bool visitStop(Stop&) { return true; }
+	void leaveStop(Stop&) {}
+
+	bool visitPrintf(Printf&) { return true; }
+	void leavePrintf(Printf&) {}
+
+	void visitEmpty(Empty&) {}
+
+	void visitReference(Reference&) {}
+
+	void visitConstant(Constant&) {}
+
+	bool visitSubField(SubField&) { return true; }
+	void leaveSubField(SubField&) {}
+
+	bool visitSubIndex(SubIndex&) { return true; }
+	void leaveSubIndex(SubIndex&) {}
+
+	bool visitSubAccess(SubAccess&) { return true; }
+	void leaveSubAccess(SubAccess&) {}
+
+	bool visitMux(Mux&) { return true; }
+	void leaveMux(Mux&) {}
+
+	bool visitCondValid(CondValid&) { return true; }
+	void leaveCondValid(CondValid&) {}
+
+	bool visitPrimOp(PrimOp&) { return true; }
+	void leavePrimOp(PrimOp&) {}
+private:
+	// Nodes left to visit. The lowest bit marks the frames that call the
+	// leave handler, as nodes are at least pointer aligned.
+	std::vector<uintptr_t> mStack;
+	uintptr_t *mTop;
+	uintptr_t *mEnd;
+
+	Derived &derived() {
+		return *static_cast<Derived*>(this);
+	}
+
+	void push(IRNode &n, bool leave = false) {
+		if (mTop == mEnd)
+			grow();
+		*mTop++ = reinterpret_cast<uintptr_t>(&n) | leave;
+	}
+
+	void grow() {
+		size_t size = mTop - mStack.data();
+		mStack.resize(mStack.empty() ? 64 : mStack.size() * 2);
+		mTop = mStack.data() + size;
+		mEnd = mStack.data() + mStack.size();
+	}
+
+	template <typename T>
+	void push(const std::vector<std::shared_ptr<T> > &c) {
+		for (auto i = c.rbegin(); i != c.rend(); ++i)
+			push(**i);
+	}
+
+	// Only pushes a leave frame if Derived has the handler
+	void enter(IRNode &n, bool leaves) {
+		if (leaves)
+			push(n, true);
+	}
+
+	// Pushes all but the first child, last first, and returns the first
+	template <typename T>
+	IRNode *children(const std::vector<std::shared_ptr<T> > &c) {
+		if (c.empty())
+			return nullptr;
+		for (size_t i = c.size() - 1; i > 0; i--)
+			push(*c[i]);
+		return c[0].get();
+	}
+
+	IRNode *visit(IRNode &n);
+	void leave(IRNode &n);
+};
+
+template <typename Derived>
+void StaticVisitor<Derived>::traverse(IRNode &n) {
+	// Handlers that traverse a subtree reuse the stack above this frame
+	size_t base = mTop - mStack.data();
+	IRNode *next = &n;
+
+	try {
+		for (;;) {
+			// The first child is visited right away, the others wait
+			if (next) {
+				next = visit(*next);
+				continue;
+			}
+
+			if (mTop == mStack.data() + base)
+				break;
+
+			uintptr_t f = *--mTop;
+
+			if (f & 1)
+				leave(*reinterpret_cast<IRNode*>(f & ~uintptr_t(1)));
+			else
+				next = reinterpret_cast<IRNode*>(f);
+		}
+	} catch (...) {
+		mTop = mStack.data() + base;
+		throw;
+	}
+}
+
+// Whether Derived declares its own leave handler for T, as the inherited
+// one is a member of StaticVisitor
+#define FIRRTLATOR_LEAVES(T) \
+	(!std::is_same<decltype(&Derived::leave##T), \
+			void (StaticVisitor::*)(T&)>::value)
+
+template <typename Derived>
+IRNode *StaticVisitor<Derived>::visit(IRNode &n) {
+	Derived &d = derived();
+
+	switch (n.getKind()) {
+	case NodeKind::Circuit: {
+		Circuit &c = static_cast<Circuit&>(n);
+		if (d.visitCircuit(c)) {
+			enter(c, FIRRTLATOR_LEAVES(Circuit));
+			push(c.mInternalModules);
+			return children(c.mExternalModules);
+		}
+		return nullptr;
+	}
+	case NodeKind::Module: {
+		Module &m = static_cast<Module&>(n);
+		if (d.visitModule(m)) {
+			enter(m, FIRRTLATOR_LEAVES(Module));
+			// Loads the body of lazily parsed modules
+			if (m.mStmts || m.getStmts())
+				push(*m.mStmts);
+			return children(m.mPorts);
+		}
+		return nullptr;
+	}
+	case NodeKind::Port: {
+		Port &p = static_cast<Port&>(n);
+		if (d.visitPort(p)) {
+			enter(p, FIRRTLATOR_LEAVES(Port));
+			return p.mType.get();
+		}
+		return nullptr;
+	}
+	case NodeKind::Parameter:
+		d.visitParameter(static_cast<Parameter&>(n));
+		return nullptr;
+	case NodeKind::Field: {
+		Field &f = static_cast<Field&>(n);
+		if (d.visitField(f)) {
+			enter(f, FIRRTLATOR_LEAVES(Field));
+			return f.mType.get();
+		}
+		return nullptr;
+	}
+	case NodeKind::ConditionalElse: {
+		ConditionalElse &e = static_cast<ConditionalElse&>(n);
+		if (d.visitConditionalElse(e)) {
+			enter(e, FIRRTLATOR_LEAVES(ConditionalElse));
+			return e.mStmts.get();
+		}
+		return nullptr;
+	}
+	case NodeKind::TypeInt:
+		d.visitTypeInt(static_cast<TypeInt&>(n));
+		return nullptr;
+	case NodeKind::TypeClock:
+		d.visitTypeClock(static_cast<TypeClock&>(n));
+		return nullptr;
+	case NodeKind::TypeBundle: {
+		TypeBundle &t = static_cast<TypeBundle&>(n);
+		if (d.visitTypeBundle(t)) {
+			enter(t, FIRRTLATOR_LEAVES(TypeBundle));
+			return children(t.mFields);
+		}
+		return nullptr;
+	}
+	case NodeKind::TypeVector: {
+		TypeVector &t = static_cast<TypeVector&>(n);
+		if (d.visitTypeVector(t)) {
+			enter(t, FIRRTLATOR_LEAVES(TypeVector));
+			return t.mType.get();
+		}
+		return nullptr;
+	}
+	case NodeKind::StmtGroup: {
+		StmtGroup &g = static_cast<StmtGroup&>(n);
+		if (d.visitStmtGroup(g)) {
+			enter(g, FIRRTLATOR_LEAVES(StmtGroup));
+			return children(g.mGroup);
+		}
+		return nullptr;
+	}
+	case NodeKind::Wire: {
+		Wire &w = static_cast<Wire&>(n);
+		if (d.visitWire(w)) {
+			enter(w, FIRRTLATOR_LEAVES(Wire));
+			return w.mType.get();
+		}
+		return nullptr;
+	}
+	case NodeKind::Reg: {
+		Reg &r = static_cast<Reg&>(n);
+		if (d.visitReg(r)) {
+			enter(r, FIRRTLATOR_LEAVES(Reg));
+			if (r.mResetTrigger && r.mResetValue) {
+				push(*r.mResetValue);
+				push(*r.mResetTrigger);
+			}
+			push(*r.mClock);
+			return r.mType.get();
+		}
+		return nullptr;
+	}
+	case NodeKind::Memory:
+		d.visitMemory(static_cast<Memory&>(n));
+		return nullptr;
+	case NodeKind::Instance: {
+		Instance &i = static_cast<Instance&>(n);
+		if (d.visitInstance(i)) {
+			enter(i, FIRRTLATOR_LEAVES(Instance));
+			return i.mOf.get();
+		}
+		return nullptr;
+	}
+	case NodeKind::Node: {
+		Node &o = static_cast<Node&>(n);
+		if (d.visitNode(o)) {
+			enter(o, FIRRTLATOR_LEAVES(Node));
+			return o.mExpr.get();
+		}
+		return nullptr;
+	}
+	case NodeKind::Connect: {
+		Connect &c = static_cast<Connect&>(n);
+		if (d.visitConnect(c)) {
+			enter(c, FIRRTLATOR_LEAVES(Connect));
+			push(*c.mFrom);
+			return c.mTo.get();
+		}
+		return nullptr;
+	}
+	case NodeKind::Invalid: {
+		Invalid &i = static_cast<Invalid&>(n);
+		if (d.visitInvalid(i)) {
+			enter(i, FIRRTLATOR_LEAVES(Invalid));
+			return i.mExp.get();
+		}
+		return nullptr;
+	}
+	case NodeKind::Conditional: {
+		Conditional &c = static_cast<Conditional&>(n);
+		if (d.visitConditional(c)) {
+			enter(c, FIRRTLATOR_LEAVES(Conditional));
+			if (c.mElse)
+				push(*c.mElse);
+			push(*c.mThen);
+			return c.mCond.get();
+		}
+		return nullptr;
+	}
+	case NodeKind::Stop: {
+		Stop &s = static_cast<Stop&>(n);
+		if (d.visitStop(s)) {
+			enter(s, FIRRTLATOR_LEAVES(Stop));
+			push(*s.mCond);
+			return s.mClock.get();
+		}
+		return nullptr;
+	}
+	case NodeKind::Printf: {
+		Printf &p = static_cast<Printf&>(n);
+		if (d.visitPrintf(p)) {
+			enter(p, FIRRTLATOR_LEAVES(Printf));
+			push(p.mArguments);
+			push(*p.mCond);
+			return p.mClock.get();
+		}
+		return nullptr;
+	}
+	case NodeKind::Empty:
+		d.visitEmpty(static_cast<Empty&>(n));
+		return nullptr;
+	case NodeKind::Reference:
+		d.visitReference(static_cast<Reference&>(n));
+		return nullptr;
+	case NodeKind::Constant:
+		d.visitConstant(static_cast<Constant&>(n));
+		return nullptr;
+	case NodeKind::SubField: {
+		SubField &s = static_cast<SubField&>(n);
+		if (d.visitSubField(s)) {
+			enter(s, FIRRTLATOR_LEAVES(SubField));
+			push(*s.mField);
+			return s.mOf.get();
+		}
+		return nullptr;
+	}
+	case NodeKind::SubIndex: {
+		SubIndex &s = static_cast<SubIndex&>(n);
+		if (d.visitSubIndex(s)) {
+			enter(s, FIRRTLATOR_LEAVES(SubIndex));
+			return s.mOf.get();
+		}
+		return nullptr;
+	}
+	case NodeKind::SubAccess: {
+		SubAccess &s = static_cast<SubAccess&>(n);
+		if (d.visitSubAccess(s)) {
+			enter(s, FIRRTLATOR_LEAVES(SubAccess));
+			push(*s.mExp);
+			return s.mOf.get();
+		}
+		return nullptr;
+	}
+	case NodeKind::Mux: {
+		Mux &m = static_cast<Mux&>(n);
+		if (d.visitMux(m)) {
+			enter(m, FIRRTLATOR_LEAVES(Mux));
+			push(*m.mB);
+			push(*m.mA);
+			return m.mSel.get();
+		}
+		return nullptr;
+	}
+	case NodeKind::CondValid: {
+		CondValid &c = static_cast<CondValid&>(n);
+		if (d.visitCondValid(c)) {
+			enter(c, FIRRTLATOR_LEAVES(CondValid));
+			push(*c.mA);
+			return c.mSel.get();
+		}
+		return nullptr;
+	}
+	case NodeKind::PrimOp: {
+		PrimOp &p = static_cast<PrimOp&>(n);
+		if (d.visitPrimOp(p)) {
+			enter(p, FIRRTLATOR_LEAVES(PrimOp));
+			return children(p.mOperands);
+		}
+		return nullptr;
+	}
+	}
+
+	return nullptr;
+}
+
+#undef FIRRTLATOR_LEAVES
+
+template <typename Derived>
+void StaticVisitor<Derived>::leave(IRNode &n) {
+	Derived &d = derived();
+
+	switch (n.getKind()) {
+	case NodeKind::Circuit:
+		d.leaveCircuit(static_cast<Circuit&>(n));
+		return;
+	case NodeKind::Module:
+		d.leaveModule(static_cast<Module&>(n));
+		return;
+	case NodeKind::Port:
+		d.leavePort(static_cast<Port&>(n));
+		return;
+	case NodeKind::Field:
+		d.leaveField(static_cast<Field&>(n));
+		return;
+	case NodeKind::ConditionalElse:
+		d.leaveConditionalElse(static_cast<ConditionalElse&>(n));
+		return;
+	case NodeKind::TypeBundle:
+		d.leaveTypeBundle(static_cast<TypeBundle&>(n));
+		return;
+	case NodeKind::TypeVector:
+		d.leaveTypeVector(static_cast<TypeVector&>(n));
+		return;
+	case NodeKind::StmtGroup:
+		d.leaveStmtGroup(static_cast<StmtGroup&>(n));
+		return;
+	case NodeKind::Wire:
+		d.leaveWire(static_cast<Wire&>(n));
+		return;
+	case NodeKind::Reg:
+		d.leaveReg(static_cast<Reg&>(n));
+		return;
+	case NodeKind::Instance:
+		d.leaveInstance(static_cast<Instance&>(n));
+		return;
+	case NodeKind::Node:
+		d.leaveNode(static_cast<Node&>(n));
+		return;
+	case NodeKind::Connect:
+		d.leaveConnect(static_cast<Connect&>(n));
+		return;
+	case NodeKind::Invalid:
+		d.leaveInvalid(static_cast<Invalid&>(n));
+		return;
+	case NodeKind::Conditional:
+		d.leaveConditional(static_cast<Conditional&>(n));
+		return;
+	case NodeKind::Stop:
+		d.leaveStop(static_cast<Stop&>(n));
+		return;
+	case NodeKind::Printf:
+		d.leavePrintf(static_cast<Printf&>(n));
+		return;
+	case NodeKind::SubField:
+		d.leaveSubField(static_cast<SubField&>(n));
+		return;
+	case NodeKind::SubIndex:
+		d.leaveSubIndex(static_cast<SubIndex&>(n));
+		return;
+	case NodeKind::SubAccess:
+		d.leaveSubAccess(static_cast<SubAccess&>(n));
+		return;
+	case NodeKind::Mux:
+		d.leaveMux(static_cast<Mux&>(n));
+		return;
+	case NodeKind::CondValid:
+		d.leaveCondValid(static_cast<CondValid&>(n));
+		return;
+	case NodeKind::PrimOp:
+		d.leavePrimOp(static_cast<PrimOp&>(n));
+		return;
+	default:
+		return;
+	}
+}
+
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <string>
+#include <ostream>
+#include <functional>
+
+namespace Firrtlator {
+
+/*
+ * An interned string. All symbols with the same content share one copy of
+ * the string in a global table, so a symbol is a single pointer and two
+ * symbols are compared by comparing the pointers. The table is safe to use
+ * from multiple threads and is never freed.
+ */
+class
+__attribute__ ((visibility ("default")))
+Symbol {
+public:
+	Symbol();
+	Symbol(const std::string &str);
+	Symbol(const char *str);
+	Symbol(const char *begin, const char *end);
+
+	const std::string &str() const { return *mString; }
+	operator const std::string &() const { return *mString; }
+	bool empty() const { return mString->empty(); }
+
+	bool operator==(const Symbol &other) const {
+		return mString == other.mString;
+	}
+	bool operator!=(const Symbol &other) const {
+		return mString != other.mString;
+	}
+	// Orders by identity, not alphabetically
+	bool operator<(const Symbol &other) const {
+		return mString < other.mString;
+	}
+
+	size_t hash() const { return std::hash<const std::string*>()(mString); }
+private:
+	const std::string *mString;
+
+	static const std::string *intern(const char *str, size_t len);
+};
+
+std::ostream& operator<< (std::ostream &os, const Symbol &s);
+
+}
+
+namespace std {
+
+template <>
+struct hash<::Firrtlator::Symbol> {
+	size_t operator()(const ::Firrtlator::Symbol &s) const {
+		return s.hash();
+	}
+};
+
+}
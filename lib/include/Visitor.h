@@ -118,4 +118,109 @@ public:
 	// TODO: all PrimOps and default calls base
 };
 
+/*
+ * Visitor that borrows the nodes instead of sharing their ownership. The
+ * traversal neither touches reference counts nor copies the child lists,
+ * which makes it the cheaper choice for passes and backends that do not
+ * keep references to the nodes they visit.
+ */
+class RefVisitor {
+public:
+	virtual ~RefVisitor();
+
+	virtual bool visit(Circuit&){ return true; };
+	virtual void leave(Circuit&){};
+
+	virtual bool visit(Module&){ return true; };
+	virtual void leave(Module&){};
+
+	virtual bool visit(Port&){ return true; };
+	virtual void leave(Port&){};
+
+	virtual bool visit(Parameter&){ return true; };
+	virtual void leave(Parameter&){};
+
+	virtual void visit(TypeInt&){};
+
+	virtual void visit(TypeClock&){};
+
+	virtual bool visit(Field&){ return true; };
+	virtual void leave(Field&){};
+
+	virtual bool visit(TypeBundle&){ return true; };
+	virtual void leave(TypeBundle&){};
+
+	virtual bool visit(TypeVector&){ return true; };
+	virtual void leave(TypeVector&){};
+
+	virtual bool visit(StmtGroup&){ return true; };
+	virtual void leave(StmtGroup&){};
+
+	virtual bool visit(Wire&){ return true; };
+	virtual void leave(Wire&){};
+
+	virtual bool visit(Reg&){ return true; };
+	virtual void leave(Reg&){};
+
+	virtual bool visit(Instance&){ return true; };
+	virtual void leave(Instance&){};
+
+	virtual bool visit(Memory&){ return true; };
+	virtual void leave(Memory&){};
+
+	virtual bool visit(Node&){ return true; };
+	virtual void leave(Node&){};
+
+	virtual bool visit(Connect&){ return true; };
+	virtual void leave(Connect&){};
+
+	virtual bool visit(Invalid&){ return true; };
+	virtual void leave(Invalid&){};
+
+	virtual bool visit(Conditional&){ return true; };
+	virtual void leave(Conditional&){};
+
+	virtual bool visit(ConditionalElse&){ return true; };
+	virtual void leave(ConditionalElse&){};
+
+	virtual bool visit(Stop&){ return true; };
+	virtual void leave(Stop&){};
+
+	virtual bool visit(Printf&){ return true; };
+	virtual void leave(Printf&){};
+
+	virtual void visit(Empty&){};
+
+	virtual void visit(Reference&){};
+
+	virtual void visit(Constant&){};
+
+	virtual bool visit(SubField&){ return true; };
+	virtual void leave(SubField&){};
+
+	virtual bool visit(SubIndex&){ return true; };
+	virtual void leave(SubIndex&){};
+
+	virtual bool visit(SubAccess&){ return true; };
+	virtual void leave(SubAccess&){};
+
+	virtual bool visit(Mux&){ return true; };
+	virtual void leave(Mux&){};
+
+	virtual bool visit(CondValid&){ return true; };
+	virtual void leave(CondValid&){};
+
+	virtual bool visit(PrimOp&){ return true; };
+	virtual void leave(PrimOp&){};
+
+};
+
+/*
+ * Walk the tree below root with the visitor, calling visit in pre-order
+ * and leave in post-order. The walk is the one of the StaticVisitor and
+ * does not recurse, so deep trees do not exhaust the stack.
+ */
+void walk(IRNode &root, Visitor &v);
+void walk(IRNode &root, RefVisitor &v);
+
 }
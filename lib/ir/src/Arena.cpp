@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace Firrtlator {
+
+static thread_local Arena *currentArena = nullptr;
+
+std::shared_ptr<Arena> Arena::create(size_t blockSize) {
+	return std::shared_ptr<Arena>(new Arena(blockSize),
+			[] (Arena *a) { a->release(); });
+}
+
+Arena::Arena(size_t blockSize)
+: mCur(nullptr), mEnd(nullptr), mBlockSize(blockSize), mAllocated(0),
+  mRefs(1) {}
+
+Arena::~Arena() {
+	for (auto b : mBlocks)
+		delete[] b;
+}
+
+void *Arena::allocate(size_t size, size_t align) {
+	uintptr_t p = ((uintptr_t) mCur + align - 1) & ~(uintptr_t) (align - 1);
+
+	if (!mCur || (p + size > (uintptr_t) mEnd)) {
+		size_t blockSize = std::max(mBlockSize, size + align);
+		mCur = new char[blockSize];
+		mEnd = mCur + blockSize;
+		mBlocks.push_back(mCur);
+		p = ((uintptr_t) mCur + align - 1) & ~(uintptr_t) (align - 1);
+	}
+
+	mCur = (char*) (p + size);
+	mAllocated += size;
+
+	return (void*) p;
+}
+
+Arena *Arena::current() {
+	return currentArena;
+}
+
+void Arena::setCurrent(Arena *arena) {
+	currentArena = arena;
+}
+
+}
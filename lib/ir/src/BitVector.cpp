@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "BitVector.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace Firrtlator {
+
+BitVector::BitVector() : mWord(0), mSize(1), mNegative(false) {}
+
+BitVector::BitVector(int64_t value)
+: mSize(1), mNegative(value < 0) {
+	mWord = mNegative ? (uint64_t) 0 - (uint64_t) value : (uint64_t) value;
+}
+
+BitVector::BitVector(const BitVector &other)
+: mSize(other.mSize), mNegative(other.mNegative) {
+	if (mSize > 1) {
+		mLimbs = new uint64_t[mSize];
+		memcpy(mLimbs, other.mLimbs, mSize * sizeof(uint64_t));
+	} else {
+		mWord = other.mWord;
+	}
+}
+
+BitVector::BitVector(BitVector &&other) : BitVector() {
+	take(other);
+}
+
+BitVector& BitVector::operator=(BitVector other) {
+	release();
+	take(other);
+	return *this;
+}
+
+BitVector::~BitVector() {
+	release();
+}
+
+void BitVector::release() {
+	if (mSize > 1)
+		delete[] mLimbs;
+	mSize = 1;
+	mWord = 0;
+	mNegative = false;
+}
+
+void BitVector::take(BitVector &other) {
+	mSize = other.mSize;
+	mNegative = other.mNegative;
+	if (mSize > 1)
+		mLimbs = other.mLimbs;
+	else
+		mWord = other.mWord;
+
+	other.mSize = 1;
+	other.mWord = 0;
+	other.mNegative = false;
+}
+
+void BitVector::grow() {
+	uint64_t *limbs = new uint64_t[mSize + 1];
+	memcpy(limbs, this->limbs(), mSize * sizeof(uint64_t));
+	limbs[mSize] = 0;
+
+	if (mSize > 1)
+		delete[] mLimbs;
+	mLimbs = limbs;
+	mSize++;
+}
+
+void BitVector::shrink() {
+	if (mSize == 1)
+		return;
+
+	uint32_t size = mSize;
+	while ((size > 1) && (mLimbs[size - 1] == 0))
+		size--;
+
+	if (size == 1) {
+		uint64_t word = mLimbs[0];
+		delete[] mLimbs;
+		mWord = word;
+	}
+	mSize = size;
+}
+
+// The limbs are processed in halves, so that all intermediate products
+// fit into 64 bits
+void BitVector::mulAdd(uint32_t mul, uint32_t add) {
+	uint64_t carry = add;
+	uint64_t *l = limbs();
+
+	for (uint32_t i = 0; i < mSize; i++) {
+		uint64_t lo = (l[i] & 0xffffffff) * mul + carry;
+		uint64_t hi = (l[i] >> 32) * mul + (lo >> 32);
+		l[i] = (hi << 32) | (lo & 0xffffffff);
+		carry = hi >> 32;
+	}
+
+	if (carry) {
+		grow();
+		limbs()[mSize - 1] = carry;
+	}
+}
+
+uint32_t BitVector::divMod(uint32_t div) {
+	uint64_t rem = 0;
+	uint64_t *l = limbs();
+
+	for (uint32_t i = mSize; i-- > 0;) {
+		uint64_t x = (rem << 32) | (l[i] >> 32);
+		uint64_t hi = x / div;
+		rem = x % div;
+		x = (rem << 32) | (l[i] & 0xffffffff);
+		l[i] = (hi << 32) | (x / div);
+		rem = x % div;
+	}
+
+	shrink();
+	return rem;
+}
+
+static int digitValue(char c) {
+	if ((c >= '0') && (c <= '9'))
+		return c - '0';
+	if ((c >= 'a') && (c <= 'f'))
+		return c - 'a' + 10;
+	if ((c >= 'A') && (c <= 'F'))
+		return c - 'A' + 10;
+	return -1;
+}
+
+BitVector BitVector::parse(const char *begin, const char *end) {
+	const char *p = begin;
+	bool negative = false;
+	unsigned base = 10;
+
+	if ((p != end) && (*p == '-')) {
+		negative = true;
+		p++;
+	}
+
+	if ((end - p >= 2) && (p[0] == '0')
+			&& ((p[1] == 'x') || (p[1] == 'o') || (p[1] == 'b'))) {
+		p++;
+	}
+
+	if (p != end) {
+		switch (*p) {
+		case 'x':
+		case 'h': base = 16; p++; break;
+		case 'o': base = 8; p++; break;
+		case 'b': base = 2; p++; break;
+		default: break;
+		}
+	}
+
+	// The sign may as well follow the radix, as in "h-1F"
+	if ((base != 10) && !negative && (p != end) && (*p == '-')) {
+		negative = true;
+		p++;
+	}
+
+	BitVector v;
+	bool digits = false;
+
+	for (; p != end; p++) {
+		if (*p == '_')
+			continue;
+
+		int d = digitValue(*p);
+		if ((d < 0) || ((unsigned) d >= base))
+			throw std::runtime_error("Invalid integer literal '"
+					+ std::string(begin, end) + "'");
+
+		v.mulAdd(base, d);
+		digits = true;
+	}
+
+	if (!digits)
+		throw std::runtime_error("Invalid integer literal '"
+				+ std::string(begin, end) + "'");
+
+	v.mNegative = negative && !v.isZero();
+	return v;
+}
+
+BitVector BitVector::parse(const std::string &literal) {
+	return parse(literal.data(), literal.data() + literal.size());
+}
+
+size_t BitVector::getWidth() const {
+	uint64_t top = limbs()[mSize - 1];
+	size_t width = (mSize - 1) * 64;
+
+	while (top) {
+		width++;
+		top >>= 1;
+	}
+
+	return width;
+}
+
+bool BitVector::fitsInt64() const {
+	if (mSize > 1)
+		return false;
+	return mNegative ? (mWord <= ((uint64_t) 1 << 63))
+			: (mWord < ((uint64_t) 1 << 63));
+}
+
+int64_t BitVector::toInt64() const {
+	if (!fitsInt64())
+		throw std::runtime_error("Integer does not fit into 64 bits");
+	return mNegative ? -(int64_t) (mWord - 1) - 1 : (int64_t) mWord;
+}
+
+std::string BitVector::toString(unsigned base) const {
+	if ((base != 2) && (base != 8) && (base != 10) && (base != 16))
+		throw std::runtime_error("Unsupported base");
+
+	if (isZero())
+		return "0";
+
+	static const char digits[] = "0123456789ABCDEF";
+	BitVector v(*this);
+	std::string s;
+
+	while (!v.isZero())
+		s.push_back(digits[v.divMod(base)]);
+
+	if (mNegative)
+		s.push_back('-');
+
+	std::reverse(s.begin(), s.end());
+	return s;
+}
+
+bool BitVector::operator==(const BitVector &other) const {
+	return (mSize == other.mSize) && (mNegative == other.mNegative)
+			&& std::equal(limbs(), limbs() + mSize, other.limbs());
+}
+
+std::ostream& operator<< (std::ostream &os, const BitVector &v) {
+	return os << v.toString();
+}
+
+}
@@ -28,12 +28,14 @@
 
 namespace Firrtlator {
 
-Circuit::Circuit() {}
+Circuit::Circuit() : IRNode(NodeKind::Circuit) {}
 
-Circuit::Circuit(std::string id) : IRNode(id) {}
+Circuit::Circuit(Symbol id) : IRNode(NodeKind::Circuit, id) {}
 
 void Circuit::addModule(std::shared_ptr<Module> mod) {
 	mModules.push_back(mod);
+	// The first definition wins, like in a scan of the modules
+	mModuleIndex.emplace(mod->getSymbol(), mod);
 	if (mod->isExternal()) {
 		mExternalModules.push_back(mod);
 	} else {
@@ -41,22 +43,33 @@ void Circuit::addModule(std::shared_ptr<Module> mod) {
 	}
 }
 
-std::vector<std::shared_ptr<Module> > Circuit::getModules() {
+const std::vector<std::shared_ptr<Module> > &Circuit::getModules() {
 	return mModules;
 }
 
-void Circuit::accept(Visitor& v) {
-	if (!v.visit(shared_from_base<Circuit>()))
-		return;
+void Circuit::setModules(const std::vector<std::shared_ptr<Module> > &modules) {
+	mModules.clear();
+	mExternalModules.clear();
+	mInternalModules.clear();
+	mModuleIndex.clear();
 
-	for (auto m : mExternalModules)
-		m->accept(v);
+	for (auto m : modules)
+		addModule(m);
+}
 
-	for (auto m : mInternalModules)
-		m->accept(v);
+std::shared_ptr<Module> Circuit::getModule(Symbol id) {
+	auto it = mModuleIndex.find(id);
+	if (it == mModuleIndex.end())
+		return nullptr;
+	return it->second;
+}
 
+void Circuit::setArena(std::shared_ptr<Arena> arena) {
+	mArena = arena;
+}
 
-	v.leave(shared_from_base<Circuit>());
+std::shared_ptr<Arena> Circuit::getArena() {
+	return mArena;
 }
 
 }
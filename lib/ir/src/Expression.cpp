@@ -22,6 +22,7 @@
 
 #include "IR.h"
 #include "Visitor.h"
+#include "FirrtlatorKeywords.h"
 
 #include <stdexcept>
 
@@ -29,9 +30,10 @@ namespace Firrtlator {
 
 typedef enum { MALE, FEMALE, BI } Gender;
 
-Expression::Expression() : mGender(MALE) {}
+Expression::Expression(NodeKind kind) : IRNode(kind), mGender(MALE) {}
 
-Expression::Expression(Gender g) : mGender(g) {}
+Expression::Expression(NodeKind kind, Gender g)
+: IRNode(kind), mGender(g) {}
 
 Expression::Gender Expression::getGender() {
 	return mGender;
@@ -39,37 +41,55 @@ Expression::Gender Expression::getGender() {
 
 Reference::Reference() : Reference("") {}
 
-Reference::Reference(std::string id) : mTo(nullptr), mToString(id) {}
+Reference::Reference(Symbol id)
+: Expression(NodeKind::Reference), mToString(id) {}
 
 bool Reference::isResolved() {
-	return (mTo != nullptr && mTo != 0);
+	return !mTo.expired();
 }
 
-std::string Reference::getToString() {
+const std::string &Reference::getToString() {
 	return mToString;
 }
 
-void Reference::accept(Visitor& v) {
-	v.visit(shared_from_base<Reference>());
+Symbol Reference::getToSymbol() {
+	return mToString;
+}
+
+std::shared_ptr<IRNode> Reference::getTo() {
+	return mTo.lock();
+}
+
+void Reference::setTo(std::shared_ptr<IRNode> to) {
+	mTo = to;
 }
 
 Constant::Constant() : Constant(nullptr, -1, UNDEFINED) {}
 
 Constant::Constant(std::shared_ptr<TypeInt> type, int val,
 		GenerateHint hint)
-: mType(type), mVal(val), mHint(hint) {}
+: Expression(NodeKind::Constant), mType(type), mVal(val), mHint(hint) {}
 
 Constant::Constant(std::shared_ptr<TypeInt> type, std::string val,
 		GenerateHint hint)
-: mType(type), mHint(hint) {
-	mVal = 0; //TODO: convert
-}
+: Constant(type, Symbol(val), hint) {}
+
+Constant::Constant(std::shared_ptr<TypeInt> type, Symbol literal,
+		GenerateHint hint)
+: Expression(NodeKind::Constant), mType(type),
+  mVal(BitVector::parse(literal)), mLiteral(literal),
+  mHint(hint) {}
+
+Constant::Constant(std::shared_ptr<TypeInt> type, BitVector val,
+		GenerateHint hint)
+: Expression(NodeKind::Constant), mType(type), mVal(std::move(val)),
+  mHint(hint) {}
 
 std::shared_ptr<TypeInt> Constant::getType() {
 	return mType;
 }
 
-int Constant::getValue() {
+const BitVector &Constant::getValue() {
 	return mVal;
 }
 
@@ -77,22 +97,39 @@ Constant::GenerateHint Constant::getHint() {
 	return mHint;
 }
 
-std::string Constant::getString() {
-	std::string t = mType->getSigned() ? "SInt" : "UInt";
-	std::string w = std::to_string(mType->getWidth());
-	std::string v = std::to_string(mVal);
+Symbol Constant::getLiteral() {
+	if (!mLiteral.empty())
+		return mLiteral;
+
+	if (mHint == STRING) {
+		std::string v = mVal.toString(16);
+		return mVal.isNegative() ? "-h" + v.substr(1) : "h" + v;
+	}
 
-	return std::string(t+"<"+w+">("+v+")");
+	return mVal.toString();
 }
 
-void Constant::accept(Visitor& v) {
-	v.visit(shared_from_base<Constant>());
+std::string Constant::getString() {
+	std::string s = mType->getSigned() ? "SInt" : "UInt";
+	if (mType->getWidth() >= 0)
+		s += "<" + std::to_string(mType->getWidth()) + ">";
+
+	std::string v = getLiteral();
+	if (mHint == STRING)
+		v = "\"" + v + "\"";
+
+	return s + "(" + v + ")";
 }
 
 SubField::SubField() : SubField(nullptr, nullptr) {}
 
 SubField::SubField(std::shared_ptr<Reference> id, std::shared_ptr<Expression> of)
-: mOf(of), mField(id) {}
+: Expression(NodeKind::SubField), mOf(of), mField(id) {}
+
+SubField::~SubField() {
+	release(mOf);
+	release(mField);
+}
 
 std::shared_ptr<Expression> SubField::getOf() {
 	return mOf;
@@ -102,20 +139,14 @@ std::shared_ptr<Reference> SubField::getField() {
 	return mField;
 }
 
-void SubField::accept(Visitor& v) {
-	if (!v.visit(shared_from_base<SubField>()))
-		return;
-
-	mOf->accept(v);
-	mField->accept(v);
-
-	v.leave(shared_from_base<SubField>());
-}
-
 SubIndex::SubIndex() : SubIndex(-1, nullptr) {}
 
 SubIndex::SubIndex(int index, std::shared_ptr<Expression> of)
-: mOf(of), mIndex(index) {}
+: Expression(NodeKind::SubIndex), mOf(of), mIndex(index) {}
+
+SubIndex::~SubIndex() {
+	release(mOf);
+}
 
 std::shared_ptr<Expression> SubIndex::getOf() {
 	return mOf;
@@ -125,20 +156,16 @@ int SubIndex::getIndex() {
 	return mIndex;
 }
 
-void SubIndex::accept(Visitor& v) {
-	if(!v.visit(shared_from_base<SubIndex>()))
-		return;
-
-	mOf->accept(v);
-
-	v.leave(shared_from_base<SubIndex>());
-}
-
 SubAccess::SubAccess() : SubAccess(nullptr, nullptr) {}
 
 SubAccess::SubAccess(std::shared_ptr<Expression> expr,
 		std::shared_ptr<Expression> of)
-: mOf(of), mExp(expr) {}
+: Expression(NodeKind::SubAccess), mOf(of), mExp(expr) {}
+
+SubAccess::~SubAccess() {
+	release(mOf);
+	release(mExp);
+}
 
 std::shared_ptr<Expression> SubAccess::getOf() {
 	return mOf;
@@ -148,21 +175,17 @@ std::shared_ptr<Expression> SubAccess::getExp() {
 	return mExp;
 }
 
-void SubAccess::accept(Visitor& v) {
-	if (!v.visit(shared_from_base<SubAccess>()))
-		return;
-
-	mOf->accept(v);
-	mExp->accept(v);
-
-	v.leave(shared_from_base<SubAccess>());
-}
-
 Mux::Mux() : Mux(nullptr, nullptr, nullptr) {}
 
 Mux::Mux(std::shared_ptr<Expression> sel, std::shared_ptr<Expression> a,
 		std::shared_ptr<Expression> b)
-: mSel(sel), mA(a), mB(b) {}
+: Expression(NodeKind::Mux), mSel(sel), mA(a), mB(b) {}
+
+Mux::~Mux() {
+	release(mSel);
+	release(mA);
+	release(mB);
+}
 
 std::shared_ptr<Expression> Mux::getSel() {
 	return mSel;
@@ -176,22 +199,16 @@ std::shared_ptr<Expression> Mux::getB() {
 	return mB;
 }
 
-void Mux::accept(Visitor& v) {
-	if (!v.visit(shared_from_base<Mux>()))
-		return;
-
-	mSel->accept(v);
-	mA->accept(v);
-	mB->accept(v);
-
-	v.leave(shared_from_base<Mux>());
-}
-
 CondValid::CondValid() : CondValid(nullptr, nullptr) {}
 
 CondValid::CondValid(std::shared_ptr<Expression> sel,
 		std::shared_ptr<Expression> a)
-: mSel(sel), mA(a) {}
+: Expression(NodeKind::CondValid), mSel(sel), mA(a) {}
+
+CondValid::~CondValid() {
+	release(mSel);
+	release(mA);
+}
 
 std::shared_ptr<Expression> CondValid::getSel() {
 	return mSel;
@@ -201,50 +218,33 @@ std::shared_ptr<Expression> CondValid::getA() {
 	return mA;
 }
 
-void CondValid::accept(Visitor& v) {
-	if (!v.visit(shared_from_base<CondValid>()))
-		return;
-
-	mSel->accept(v);
-	mA->accept(v);
-
-	v.leave(shared_from_base<CondValid>());
-}
-
-const bool PrimOp::lookup(std::string v, Operation &op) {
-	static const std::map<std::string, Operation> map =	{
-		{"add", ADD}, {"sub", SUB }, {"mul", MUL },
-		{"div", DIV}, {"mod", MOD }, {"lt", LT },
-		{"leq", LEQ}, {"gt", GT}, {"geq", GEQ }, {"eq", EQ},
-	    {"neq", NEQ}, {"pad", PAD}, {"asUInt", ASUINT},
-		{"asSInt", ASSINT}, {"asClock", ASCLOCK},
-		{"shl", SHL}, {"shr", SHR}, {"dshl", DSHL},
-		{"dshr", DSHR}, {"cvt", CVT}, {"neg", NEG},
-		{"not", NOT}, {"and", AND}, {"or", OR},
-		{"xor", XOR}, {"andr", ANDR}, {"orr", ORR},
-		{"xorr", XORR}, {"cat", CAT}, {"bits", BITS},
-		{"head", HEAD}, {"tail", TAIL}
-	};
+const bool PrimOp::lookup(const std::string &v, Operation &op) {
+	const Keywords::Entry *e;
+	e = Keywords::lookup(v.data(), v.size());
 
-	if (map.find(v) == map.end()) {
+	if (!e || (e->keyword != Keywords::PRIMOP)) {
 		op = UNDEFINED;
 		return false;
 	}
 
-	op = map.find(v)->second;
+	op = e->op;
 	return true;
 }
 
 PrimOp::PrimOp() : PrimOp(UNDEFINED, 0, 0) {}
 
 PrimOp::PrimOp(Operation op, int numOps, int numParams) :
-		Expression(MALE), mOp(op),
+		Expression(NodeKind::PrimOp, MALE), mOp(op),
 		mNumOperands(numOps), mNumParameters(numParams) {
 
 }
 
+PrimOp::~PrimOp() {
+	release(mOperands);
+}
+
 std::shared_ptr<PrimOp> PrimOp::generate(const Operation &op) {
-#define GENOP(x) case x: return std::make_shared<PrimOp##x>();
+#define GENOP(x) case x: return make_node<PrimOp##x>();
 	switch (op) {
 	GENOP(ADD);	GENOP(SUB);	GENOP(MUL);	GENOP(DIV);	GENOP(MOD);
 	GENOP(LT); GENOP(LEQ); GENOP(GT); GENOP(GEQ); GENOP(EQ);
@@ -308,22 +308,12 @@ PrimOp::Operation PrimOp::getOp() {
 	return mOp;
 }
 
-std::vector<std::shared_ptr<Expression> > PrimOp::getOperands() {
+const std::vector<std::shared_ptr<Expression> > &PrimOp::getOperands() {
 	return mOperands;
 }
 
-std::vector<int> PrimOp::getParameters() {
+const std::vector<int> &PrimOp::getParameters() {
 	return mParameters;
 }
 
-void PrimOp::accept(Visitor& v) {
-	if (!v.visit(shared_from_base<PrimOp>()))
-		return;
-
-	for (auto o : mOperands)
-		o->accept(v);
-
-	v.leave(shared_from_base<PrimOp>());
-}
-
 }
@@ -0,0 +1,836 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "FlatIR.h"
+#include "StaticVisitor.h"
+
+#include <unordered_map>
+
+namespace Firrtlator {
+
+typedef FlatCircuit::Handle Handle;
+typedef FlatCircuit::Range Range;
+
+const uint32_t FlatCircuit::none;
+
+namespace {
+
+/*
+ * Appends the nodes of a circuit to the tables. The children of a node
+ * are converted first and left on a stack of handles, from which the node
+ * takes them when it is left, so deep trees are converted without
+ * recursion. Circuit, modules, memories and constants convert the children
+ * that the walk does not visit themselves.
+ */
+class Flattener : public StaticVisitor<Flattener> {
+public:
+	Flattener(FlatCircuit &flat) : mFlat(flat) {}
+
+	bool visitCircuit(Circuit &c);
+	bool visitModule(Module &m);
+	void leavePort(Port &p);
+	bool visitParameter(Parameter &p);
+	void leaveField(Field &f);
+	void leaveConditionalElse(ConditionalElse &e);
+	void visitTypeInt(TypeInt &t);
+	void visitTypeClock(TypeClock &t);
+	void leaveTypeBundle(TypeBundle &t);
+	void leaveTypeVector(TypeVector &t);
+	void leaveStmtGroup(StmtGroup &g);
+	void leaveWire(Wire &w);
+	void leaveReg(Reg &r);
+	bool visitMemory(Memory &m);
+	void leaveInstance(Instance &i);
+	void leaveNode(Node &n);
+	void leaveConnect(Connect &c);
+	void leaveInvalid(Invalid &i);
+	void leaveConditional(Conditional &c);
+	void leaveStop(Stop &s);
+	void leavePrintf(Printf &p);
+	void visitEmpty(Empty &e);
+	void visitReference(Reference &r);
+	void visitConstant(Constant &c);
+	void leaveSubField(SubField &s);
+	void leaveSubIndex(SubIndex &s);
+	void leaveSubAccess(SubAccess &s);
+	void leaveMux(Mux &m);
+	void leaveCondValid(CondValid &c);
+	void leavePrimOp(PrimOp &p);
+private:
+	FlatCircuit &mFlat;
+	std::vector<Handle> mValues;
+	std::unordered_map<Symbol, uint32_t> mStrings;
+	std::unordered_map<const Info*, uint32_t> mInfos;
+
+	uint32_t string(Symbol s);
+	uint32_t info(IRNode &n);
+	Handle add(FlatCircuit::Table &t, NodeKind kind, IRNode &n);
+	Handle add(FlatCircuit::NamedTable &t, NodeKind kind, IRNode &n);
+
+	Handle pop();
+	// Moves the last n handles to the lists
+	Range list(size_t n);
+	Range strings(const std::vector<std::string> &list);
+	Handle convert(std::shared_ptr<IRNode> n);
+};
+
+uint32_t Flattener::string(Symbol s) {
+	auto it = mStrings.find(s);
+	if (it != mStrings.end())
+		return it->second;
+
+	uint32_t index = mFlat.strings.size();
+	mFlat.strings.push_back(s);
+	mStrings[s] = index;
+	return index;
+}
+
+uint32_t Flattener::info(IRNode &n) {
+	std::shared_ptr<Info> info = n.getInfo();
+	if (!info)
+		return FlatCircuit::none;
+
+	// The frontends share the Info nodes of identical locators
+	auto it = mInfos.find(info.get());
+	if (it != mInfos.end())
+		return it->second;
+
+	uint32_t index = mFlat.infos.size();
+	mFlat.infos.push_back(info);
+	mInfos[info.get()] = index;
+	return index;
+}
+
+Handle Flattener::add(FlatCircuit::Table &t, NodeKind kind, IRNode &n) {
+	throwAssert(n.getSymbol().empty(), "Node kind has no name");
+	throwAssert(t.size() < (1 << 27), "Too many nodes of one kind");
+	t.info.push_back(info(n));
+	return FlatCircuit::handle(kind, t.size() - 1);
+}
+
+Handle Flattener::add(FlatCircuit::NamedTable &t, NodeKind kind,
+		IRNode &n) {
+	throwAssert(t.size() < (1 << 27), "Too many nodes of one kind");
+	t.info.push_back(info(n));
+	Symbol name = n.getSymbol();
+	t.name.push_back(name.empty() ? FlatCircuit::none : string(name));
+	return FlatCircuit::handle(kind, t.size() - 1);
+}
+
+Handle Flattener::pop() {
+	Handle h = mValues.back();
+	mValues.pop_back();
+	return h;
+}
+
+Range Flattener::list(size_t n) {
+	Range r = { (uint32_t) mFlat.lists.size(), (uint32_t) n };
+	mFlat.lists.insert(mFlat.lists.end(), mValues.end() - n, mValues.end());
+	mValues.resize(mValues.size() - n);
+	return r;
+}
+
+Range Flattener::strings(const std::vector<std::string> &list) {
+	Range r = { (uint32_t) mFlat.stringLists.size(), (uint32_t) list.size() };
+	for (const auto &s : list)
+		mFlat.stringLists.push_back(string(s));
+	return r;
+}
+
+Handle Flattener::convert(std::shared_ptr<IRNode> n) {
+	if (!n)
+		return FlatCircuit::none;
+
+	traverse(*n);
+	return pop();
+}
+
+bool Flattener::visitCircuit(Circuit &c) {
+	for (const auto &m : c.getModules())
+		traverse(*m);
+
+	Symbol name = c.getSymbol();
+	mFlat.circuit.name = name.empty() ? FlatCircuit::none : string(name);
+	mFlat.circuit.info = info(c);
+	mFlat.circuit.modules = list(c.getModules().size());
+	return false;
+}
+
+bool Flattener::visitModule(Module &m) {
+	for (const auto &p : m.getPorts())
+		traverse(*p);
+	Range ports = list(m.getPorts().size());
+	for (const auto &p : m.getParameters())
+		traverse(*p);
+	Range parameters = list(m.getParameters().size());
+	Handle stmts = convert(m.getStmts());
+
+	auto &t = mFlat.modules;
+	Handle h = add(t, NodeKind::Module, m);
+	t.external.push_back(m.isExternal());
+	std::string defname = m.getDefname();
+	t.defname.push_back(defname.empty() ? FlatCircuit::none :
+			string(defname));
+	t.ports.push_back(ports);
+	t.parameters.push_back(parameters);
+	t.stmts.push_back(stmts);
+	mValues.push_back(h);
+	return false;
+}
+
+void Flattener::leavePort(Port &p) {
+	auto &t = mFlat.ports;
+	Handle type = pop();
+	Handle h = add(t, NodeKind::Port, p);
+	t.output.push_back(p.getDirection() == Port::OUTPUT);
+	t.type.push_back(type);
+	mValues.push_back(h);
+}
+
+bool Flattener::visitParameter(Parameter &p) {
+	mValues.push_back(add(mFlat.parameters, NodeKind::Parameter, p));
+	return false;
+}
+
+void Flattener::leaveField(Field &f) {
+	auto &t = mFlat.fields;
+	Handle type = pop();
+	Handle h = add(t, NodeKind::Field, f);
+	t.flip.push_back(f.getFlip());
+	t.type.push_back(type);
+	mValues.push_back(h);
+}
+
+void Flattener::leaveConditionalElse(ConditionalElse &e) {
+	auto &t = mFlat.conditionalElses;
+	Handle stmts = pop();
+	Handle h = add(t, NodeKind::ConditionalElse, e);
+	t.stmts.push_back(stmts);
+	mValues.push_back(h);
+}
+
+void Flattener::visitTypeInt(TypeInt &i) {
+	auto &t = mFlat.typeInts;
+	Handle h = add(t, NodeKind::TypeInt, i);
+	t.width.push_back(i.getWidth());
+	t.sign.push_back(i.getSigned());
+	mValues.push_back(h);
+}
+
+void Flattener::visitTypeClock(TypeClock &c) {
+	mValues.push_back(add(mFlat.typeClocks, NodeKind::TypeClock, c));
+}
+
+void Flattener::leaveTypeBundle(TypeBundle &b) {
+	auto &t = mFlat.typeBundles;
+	Range fields = list(b.getFields().size());
+	Handle h = add(t, NodeKind::TypeBundle, b);
+	t.fields.push_back(fields);
+	mValues.push_back(h);
+}
+
+void Flattener::leaveTypeVector(TypeVector &v) {
+	auto &t = mFlat.typeVectors;
+	Handle type = v.getType() ? pop() : FlatCircuit::none;
+	Handle h = add(t, NodeKind::TypeVector, v);
+	t.type.push_back(type);
+	t.size.push_back(v.getSize());
+	mValues.push_back(h);
+}
+
+void Flattener::leaveStmtGroup(StmtGroup &g) {
+	auto &t = mFlat.stmtGroups;
+	Range stmts = list(g.end() - g.begin());
+	Handle h = add(t, NodeKind::StmtGroup, g);
+	t.stmts.push_back(stmts);
+	mValues.push_back(h);
+}
+
+void Flattener::leaveWire(Wire &w) {
+	auto &t = mFlat.wires;
+	Handle type = pop();
+	Handle h = add(t, NodeKind::Wire, w);
+	t.type.push_back(type);
+	mValues.push_back(h);
+}
+
+void Flattener::leaveReg(Reg &r) {
+	auto &t = mFlat.regs;
+	// The walk only visits the reset if both of its parts are set
+	bool reset = r.getResetTrigger() && r.getResetValue();
+	Handle value = reset ? pop() : FlatCircuit::none;
+	Handle trigger = reset ? pop() : FlatCircuit::none;
+	Handle clock = pop();
+	Handle type = pop();
+	if (!reset) {
+		trigger = convert(r.getResetTrigger());
+		value = convert(r.getResetValue());
+	}
+
+	Handle h = add(t, NodeKind::Reg, r);
+	t.type.push_back(type);
+	t.clock.push_back(clock);
+	t.resetTrigger.push_back(trigger);
+	t.resetValue.push_back(value);
+	mValues.push_back(h);
+}
+
+bool Flattener::visitMemory(Memory &m) {
+	auto &t = mFlat.memories;
+	Handle dtype = convert(m.getDType());
+	Handle h = add(t, NodeKind::Memory, m);
+	t.dtype.push_back(dtype);
+	t.depth.push_back(m.getDepth());
+	t.readLatency.push_back(m.getReadlatency());
+	t.writeLatency.push_back(m.getWritelatency());
+	t.ruw.push_back(m.getRuwflag());
+	t.readers.push_back(strings(m.getReaders()));
+	t.writers.push_back(strings(m.getWriters()));
+	t.readWriters.push_back(strings(m.getReadWriters()));
+	mValues.push_back(h);
+	return false;
+}
+
+void Flattener::leaveInstance(Instance &i) {
+	auto &t = mFlat.instances;
+	Handle of = pop();
+	Handle h = add(t, NodeKind::Instance, i);
+	t.of.push_back(of);
+	mValues.push_back(h);
+}
+
+void Flattener::leaveNode(Node &n) {
+	auto &t = mFlat.nodes;
+	Handle expr = pop();
+	Handle h = add(t, NodeKind::Node, n);
+	t.expr.push_back(expr);
+	mValues.push_back(h);
+}
+
+void Flattener::leaveConnect(Connect &c) {
+	auto &t = mFlat.connects;
+	Handle from = pop();
+	Handle to = pop();
+	Handle h = add(t, NodeKind::Connect, c);
+	t.to.push_back(to);
+	t.from.push_back(from);
+	t.partial.push_back(c.getPartial());
+	mValues.push_back(h);
+}
+
+void Flattener::leaveInvalid(Invalid &i) {
+	auto &t = mFlat.invalids;
+	Handle expr = pop();
+	Handle h = add(t, NodeKind::Invalid, i);
+	t.expr.push_back(expr);
+	mValues.push_back(h);
+}
+
+void Flattener::leaveConditional(Conditional &c) {
+	auto &t = mFlat.conditionals;
+	Handle otherwise = c.getElse() ? pop() : FlatCircuit::none;
+	Handle then = pop();
+	Handle cond = pop();
+	Handle h = add(t, NodeKind::Conditional, c);
+	t.cond.push_back(cond);
+	t.then.push_back(then);
+	t.otherwise.push_back(otherwise);
+	mValues.push_back(h);
+}
+
+void Flattener::leaveStop(Stop &s) {
+	auto &t = mFlat.stops;
+	Handle cond = pop();
+	Handle clock = pop();
+	Handle h = add(t, NodeKind::Stop, s);
+	t.clock.push_back(clock);
+	t.cond.push_back(cond);
+	t.code.push_back(s.getCode());
+	mValues.push_back(h);
+}
+
+void Flattener::leavePrintf(Printf &p) {
+	auto &t = mFlat.printfs;
+	Range arguments = list(p.getArguments().size());
+	Handle cond = pop();
+	Handle clock = pop();
+	Handle h = add(t, NodeKind::Printf, p);
+	t.clock.push_back(clock);
+	t.cond.push_back(cond);
+	t.format.push_back(string(p.getFormat()));
+	t.arguments.push_back(arguments);
+	mValues.push_back(h);
+}
+
+void Flattener::visitEmpty(Empty &e) {
+	mValues.push_back(add(mFlat.empties, NodeKind::Empty, e));
+}
+
+void Flattener::visitReference(Reference &r) {
+	auto &t = mFlat.references;
+	Handle h = add(t, NodeKind::Reference, r);
+	t.to.push_back(string(r.getToSymbol()));
+	mValues.push_back(h);
+}
+
+void Flattener::visitConstant(Constant &c) {
+	auto &t = mFlat.constants;
+	Handle type = convert(c.getType());
+	Handle h = add(t, NodeKind::Constant, c);
+	t.type.push_back(type);
+	t.literal.push_back(string(c.getLiteral()));
+	t.hint.push_back(c.getHint());
+	mValues.push_back(h);
+}
+
+void Flattener::leaveSubField(SubField &s) {
+	auto &t = mFlat.subFields;
+	Handle field = pop();
+	Handle of = pop();
+	Handle h = add(t, NodeKind::SubField, s);
+	t.of.push_back(of);
+	t.field.push_back(field);
+	mValues.push_back(h);
+}
+
+void Flattener::leaveSubIndex(SubIndex &s) {
+	auto &t = mFlat.subIndices;
+	Handle of = pop();
+	Handle h = add(t, NodeKind::SubIndex, s);
+	t.of.push_back(of);
+	t.index.push_back(s.getIndex());
+	mValues.push_back(h);
+}
+
+void Flattener::leaveSubAccess(SubAccess &s) {
+	auto &t = mFlat.subAccesses;
+	Handle expr = pop();
+	Handle of = pop();
+	Handle h = add(t, NodeKind::SubAccess, s);
+	t.of.push_back(of);
+	t.expr.push_back(expr);
+	mValues.push_back(h);
+}
+
+void Flattener::leaveMux(Mux &m) {
+	auto &t = mFlat.muxes;
+	Handle b = pop();
+	Handle a = pop();
+	Handle sel = pop();
+	Handle h = add(t, NodeKind::Mux, m);
+	t.sel.push_back(sel);
+	t.a.push_back(a);
+	t.b.push_back(b);
+	mValues.push_back(h);
+}
+
+void Flattener::leaveCondValid(CondValid &c) {
+	auto &t = mFlat.condValids;
+	Handle a = pop();
+	Handle sel = pop();
+	Handle h = add(t, NodeKind::CondValid, c);
+	t.sel.push_back(sel);
+	t.a.push_back(a);
+	mValues.push_back(h);
+}
+
+void Flattener::leavePrimOp(PrimOp &p) {
+	auto &t = mFlat.primOps;
+	Range operands = list(p.getOperands().size());
+	Handle h = add(t, NodeKind::PrimOp, p);
+	t.op.push_back(p.getOp());
+	t.operands.push_back(operands);
+	const auto &params = p.getParameters();
+	Range parameters = { (uint32_t) mFlat.intLists.size(),
+			(uint32_t) params.size() };
+	mFlat.intLists.insert(mFlat.intLists.end(), params.begin(), params.end());
+	t.parameters.push_back(parameters);
+	mValues.push_back(h);
+}
+
+/*
+ * Creates the nodes of the tree below a handle. The walk keeps the
+ * handles on an explicit stack and a node is created once its children
+ * are, which are then the last entries of the values.
+ */
+class Builder {
+public:
+	Builder(const FlatCircuit &flat) : mFlat(flat) {}
+
+	std::shared_ptr<IRNode> build(Handle root);
+private:
+	const FlatCircuit &mFlat;
+
+	Symbol string(uint32_t index);
+	std::shared_ptr<IRNode> make(Handle h,
+			std::vector<std::shared_ptr<IRNode> >::iterator args);
+};
+
+// Takes the next of the children created for a node
+template <typename T>
+std::shared_ptr<T> next(std::vector<std::shared_ptr<IRNode> >::iterator &it) {
+	return cast<T>(*it++);
+}
+
+template <typename T>
+std::shared_ptr<T> next(std::vector<std::shared_ptr<IRNode> >::iterator &it,
+		Handle h) {
+	return (h == FlatCircuit::none) ? nullptr : next<T>(it);
+}
+
+std::shared_ptr<IRNode> Builder::build(Handle root) {
+	struct Frame {
+		Handle handle;
+		// Position of the first child in the values, once pushed
+		size_t base;
+	};
+	const size_t pending = (size_t) -1;
+
+	std::vector<Frame> stack(1, Frame { root, pending });
+	std::vector<std::shared_ptr<IRNode> > values;
+
+	while (!stack.empty()) {
+		if (stack.back().base == pending) {
+			Handle h = stack.back().handle;
+			stack.back().base = values.size();
+
+			// The children are pushed last first to be created in order
+			size_t top = stack.size();
+			mFlat.forEachChild(h, [&stack, pending] (Handle c) {
+				stack.push_back(Frame { c, pending });
+			});
+			std::reverse(stack.begin() + top, stack.end());
+			continue;
+		}
+
+		Frame f = stack.back();
+		stack.pop_back();
+
+		std::shared_ptr<IRNode> node = make(f.handle, values.begin() + f.base);
+		node->setInfo(mFlat.getInfo(f.handle));
+		values.resize(f.base);
+		values.push_back(node);
+	}
+
+	return values.back();
+}
+
+Symbol Builder::string(uint32_t index) {
+	return (index == FlatCircuit::none) ? Symbol() : mFlat.strings[index];
+}
+
+std::shared_ptr<IRNode> Builder::make(Handle h,
+		std::vector<std::shared_ptr<IRNode> >::iterator args) {
+	uint32_t r = FlatCircuit::row(h);
+	Symbol name = mFlat.getName(h);
+
+	switch (FlatCircuit::kind(h)) {
+	case NodeKind::Module: {
+		const auto &t = mFlat.modules;
+		auto m = make_node<Module>(name, t.external[r]);
+		if (t.defname[r] != FlatCircuit::none)
+			m->setDefname(string(t.defname[r]));
+		for (uint32_t i = 0; i < t.ports[r].size; i++)
+			m->addPort(next<Port>(args));
+		for (uint32_t i = 0; i < t.parameters[r].size; i++)
+			m->addParameter(next<Parameter>(args));
+		if (t.stmts[r] != FlatCircuit::none)
+			m->setStatementGroup(next<StmtGroup>(args));
+		return m;
+	}
+	case NodeKind::Port: {
+		Port::Direction dir = mFlat.ports.output[r] ?
+				Port::OUTPUT : Port::INPUT;
+		return make_node<Port>(name, dir, next<Type>(args));
+	}
+	case NodeKind::Parameter:
+		return make_node<Parameter>();
+	case NodeKind::Field: {
+		std::shared_ptr<Type> type = next<Type>(args);
+		return make_node<Field>(name, type, mFlat.fields.flip[r]);
+	}
+	case NodeKind::ConditionalElse: {
+		auto e = make_node<ConditionalElse>();
+		if (mFlat.conditionalElses.stmts[r] != FlatCircuit::none)
+			e->setStmts(next<StmtGroup>(args));
+		return e;
+	}
+	case NodeKind::TypeInt:
+		return make_node<TypeInt>(mFlat.typeInts.sign[r],
+				mFlat.typeInts.width[r]);
+	case NodeKind::TypeClock:
+		return make_node<TypeClock>();
+	case NodeKind::TypeBundle: {
+		auto b = make_node<TypeBundle>();
+		for (uint32_t i = 0; i < mFlat.typeBundles.fields[r].size; i++)
+			b->addField(next<Field>(args));
+		return b;
+	}
+	case NodeKind::TypeVector: {
+		const auto &t = mFlat.typeVectors;
+		std::shared_ptr<Type> type = next<Type>(args, t.type[r]);
+		return make_node<TypeVector>(type, t.size[r]);
+	}
+	case NodeKind::StmtGroup: {
+		auto g = make_node<StmtGroup>();
+		for (uint32_t i = 0; i < mFlat.stmtGroups.stmts[r].size; i++)
+			g->addStatement(next<Stmt>(args));
+		return g;
+	}
+	case NodeKind::Wire:
+		return make_node<Wire>(name, next<Type>(args));
+	case NodeKind::Reg: {
+		const auto &t = mFlat.regs;
+		std::shared_ptr<Type> type = next<Type>(args);
+		auto reg = make_node<Reg>(name, type, next<Expression>(args));
+		if (t.resetTrigger[r] != FlatCircuit::none)
+			reg->setResetTrigger(next<Expression>(args));
+		if (t.resetValue[r] != FlatCircuit::none)
+			reg->setResetValue(next<Expression>(args));
+		return reg;
+	}
+	case NodeKind::Memory: {
+		const auto &t = mFlat.memories;
+		auto mem = make_node<Memory>(name);
+		if (t.dtype[r] != FlatCircuit::none)
+			mem->setDType(next<Type>(args));
+		if (t.depth[r] >= 0)
+			mem->setDepth(t.depth[r]);
+		if (t.readLatency[r] >= 0)
+			mem->setReadLatency(t.readLatency[r]);
+		if (t.writeLatency[r] >= 0)
+			mem->setWriteLatency(t.writeLatency[r]);
+		mem->setRuwFlag((Memory::RuwFlag) t.ruw[r]);
+
+		const uint32_t *s = mFlat.stringLists.data();
+		for (uint32_t i = 0; i < t.readers[r].size; i++)
+			mem->addReader(string(s[t.readers[r].begin + i]));
+		for (uint32_t i = 0; i < t.writers[r].size; i++)
+			mem->addWriter(string(s[t.writers[r].begin + i]));
+		for (uint32_t i = 0; i < t.readWriters[r].size; i++)
+			mem->addReadWriter(string(s[t.readWriters[r].begin + i]));
+		return mem;
+	}
+	case NodeKind::Instance:
+		return make_node<Instance>(name, next<Reference>(args));
+	case NodeKind::Node:
+		return make_node<Node>(name, next<Expression>(args));
+	case NodeKind::Connect: {
+		std::shared_ptr<Expression> to = next<Expression>(args);
+		return make_node<Connect>(to, next<Expression>(args),
+				mFlat.connects.partial[r]);
+	}
+	case NodeKind::Invalid:
+		return make_node<Invalid>(next<Expression>(args));
+	case NodeKind::Conditional: {
+		const auto &t = mFlat.conditionals;
+		auto cond = make_node<Conditional>(next<Expression>(args));
+		if (t.then[r] != FlatCircuit::none)
+			cond->setThen(next<StmtGroup>(args));
+		if (t.otherwise[r] != FlatCircuit::none)
+			cond->setElse(next<ConditionalElse>(args));
+		return cond;
+	}
+	case NodeKind::Stop: {
+		std::shared_ptr<Expression> clock = next<Expression>(args);
+		std::shared_ptr<Expression> cond = next<Expression>(args);
+		return make_node<Stop>(clock, cond, mFlat.stops.code[r]);
+	}
+	case NodeKind::Printf: {
+		const auto &t = mFlat.printfs;
+		std::shared_ptr<Expression> clock = next<Expression>(args);
+		std::shared_ptr<Expression> cond = next<Expression>(args);
+		auto print = make_node<Printf>(clock, cond, string(t.format[r]));
+		for (uint32_t i = 0; i < t.arguments[r].size; i++)
+			print->addArgument(next<Expression>(args));
+		return print;
+	}
+	case NodeKind::Empty:
+		return make_node<Empty>();
+	case NodeKind::Reference:
+		return make_node<Reference>(string(mFlat.references.to[r]));
+	case NodeKind::Constant: {
+		const auto &t = mFlat.constants;
+		std::shared_ptr<TypeInt> type = next<TypeInt>(args, t.type[r]);
+		return make_node<Constant>(type, string(t.literal[r]),
+				(Constant::GenerateHint) t.hint[r]);
+	}
+	case NodeKind::SubField: {
+		std::shared_ptr<Expression> of = next<Expression>(args);
+		return make_node<SubField>(next<Reference>(args), of);
+	}
+	case NodeKind::SubIndex:
+		return make_node<SubIndex>(mFlat.subIndices.index[r],
+				next<Expression>(args));
+	case NodeKind::SubAccess: {
+		std::shared_ptr<Expression> of = next<Expression>(args);
+		return make_node<SubAccess>(next<Expression>(args), of);
+	}
+	case NodeKind::Mux: {
+		std::shared_ptr<Expression> sel = next<Expression>(args);
+		std::shared_ptr<Expression> a = next<Expression>(args);
+		return make_node<Mux>(sel, a, next<Expression>(args));
+	}
+	case NodeKind::CondValid: {
+		std::shared_ptr<Expression> sel = next<Expression>(args);
+		return make_node<CondValid>(sel, next<Expression>(args));
+	}
+	case NodeKind::PrimOp: {
+		const auto &t = mFlat.primOps;
+		auto op = PrimOp::generate((PrimOp::Operation) t.op[r]);
+		for (uint32_t i = 0; i < t.operands[r].size; i++)
+			op->addOperand(next<Expression>(args));
+		const int32_t *p = mFlat.intLists.data() + t.parameters[r].begin;
+		for (uint32_t i = 0; i < t.parameters[r].size; i++)
+			op->addParameter(p[i]);
+		return op;
+	}
+	default:
+		throw std::runtime_error("Invalid handle");
+	}
+}
+
+template <typename T>
+size_t bytes(const std::vector<T> &v) {
+	return v.capacity() * sizeof(T);
+}
+
+}
+
+FlatCircuit::FlatCircuit(std::shared_ptr<Circuit> ir) {
+	Table *tables[] = {
+		nullptr, &modules, &ports, &parameters, &fields, &conditionalElses,
+		&typeInts, &typeClocks, &typeBundles, &typeVectors,
+		&stmtGroups, &wires, &regs, &memories, &instances, &nodes,
+		&connects, &invalids, &conditionals, &stops, &printfs, &empties,
+		&references, &constants, &subFields, &subIndices, &subAccesses,
+		&muxes, &condValids, &primOps
+	};
+	static_assert(sizeof(tables) == sizeof(mTables),
+			"Missing table of a node kind");
+	std::copy(tables, tables + sizeof(tables) / sizeof(tables[0]), mTables);
+
+	std::fill(mNamedTables, mNamedTables + sizeof(mNamedTables) /
+			sizeof(mNamedTables[0]), nullptr);
+	mNamedTables[(size_t) NodeKind::Module] = &modules;
+	mNamedTables[(size_t) NodeKind::Port] = &ports;
+	mNamedTables[(size_t) NodeKind::Field] = &fields;
+	mNamedTables[(size_t) NodeKind::Wire] = &wires;
+	mNamedTables[(size_t) NodeKind::Reg] = &regs;
+	mNamedTables[(size_t) NodeKind::Memory] = &memories;
+	mNamedTables[(size_t) NodeKind::Instance] = &instances;
+	mNamedTables[(size_t) NodeKind::Node] = &nodes;
+
+	Flattener f(*this);
+	f.traverse(*ir);
+}
+
+std::shared_ptr<Circuit> FlatCircuit::toIR() const {
+	auto arena = Arena::create();
+	ArenaScope scope(arena);
+	Builder builder(*this);
+
+	Symbol name = (circuit.name == none) ? Symbol() : strings[circuit.name];
+	auto c = make_node<Circuit>(name);
+	if (circuit.info != none)
+		c->setInfo(infos[circuit.info]);
+	for (const Handle *m = begin(circuit.modules); m != end(circuit.modules);
+			++m)
+		c->addModule(cast<Module>(builder.build(*m)));
+
+	c->setArena(arena);
+	return c;
+}
+
+std::shared_ptr<Info> FlatCircuit::getInfo(Handle h) const {
+	uint32_t info = mTables[(size_t) kind(h)]->info[row(h)];
+	return (info == none) ? nullptr : infos[info];
+}
+
+Symbol FlatCircuit::getName(Handle h) const {
+	NamedTable *t = mNamedTables[(size_t) kind(h)];
+	if (!t || (t->name[row(h)] == none))
+		return Symbol();
+	return strings[t->name[row(h)]];
+}
+
+size_t FlatCircuit::getNodeCount() const {
+	size_t count = 1;
+	for (auto t : mTables)
+		if (t)
+			count += t->size();
+	return count;
+}
+
+size_t FlatCircuit::getMemoryUsage() const {
+	size_t size = sizeof(*this) + bytes(strings) + bytes(infos)
+			+ bytes(lists) + bytes(stringLists) + bytes(intLists);
+
+	for (auto t : mTables)
+		if (t)
+			size += bytes(t->info);
+	for (auto t : mNamedTables)
+		if (t)
+			size += bytes(t->name);
+
+	size += bytes(modules.external) + bytes(modules.defname)
+			+ bytes(modules.ports) + bytes(modules.parameters)
+			+ bytes(modules.stmts);
+	size += bytes(ports.output) + bytes(ports.type);
+	size += bytes(fields.flip) + bytes(fields.type);
+	size += bytes(conditionalElses.stmts);
+	size += bytes(typeInts.width) + bytes(typeInts.sign);
+	size += bytes(typeBundles.fields);
+	size += bytes(typeVectors.type) + bytes(typeVectors.size);
+	size += bytes(stmtGroups.stmts);
+	size += bytes(wires.type);
+	size += bytes(regs.type) + bytes(regs.clock) + bytes(regs.resetTrigger)
+			+ bytes(regs.resetValue);
+	size += bytes(memories.dtype) + bytes(memories.depth)
+			+ bytes(memories.readLatency) + bytes(memories.writeLatency)
+			+ bytes(memories.ruw) + bytes(memories.readers)
+			+ bytes(memories.writers) + bytes(memories.readWriters);
+	size += bytes(instances.of);
+	size += bytes(nodes.expr);
+	size += bytes(connects.to) + bytes(connects.from)
+			+ bytes(connects.partial);
+	size += bytes(invalids.expr);
+	size += bytes(conditionals.cond) + bytes(conditionals.then)
+			+ bytes(conditionals.otherwise);
+	size += bytes(stops.clock) + bytes(stops.cond) + bytes(stops.code);
+	size += bytes(printfs.clock) + bytes(printfs.cond)
+			+ bytes(printfs.format) + bytes(printfs.arguments);
+	size += bytes(references.to);
+	size += bytes(constants.type) + bytes(constants.literal)
+			+ bytes(constants.hint);
+	size += bytes(subFields.of) + bytes(subFields.field);
+	size += bytes(subIndices.of) + bytes(subIndices.index);
+	size += bytes(subAccesses.of) + bytes(subAccesses.expr);
+	size += bytes(muxes.sel) + bytes(muxes.a) + bytes(muxes.b);
+	size += bytes(condValids.sel) + bytes(condValids.a);
+	size += bytes(primOps.op) + bytes(primOps.operands)
+			+ bytes(primOps.parameters);
+
+	return size;
+}
+
+}
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Hierarchy.h"
+#include "Visitor.h"
+
+namespace Firrtlator {
+
+// Number of bits of a type, with unknown widths counted as zero
+static uint64_t bits(std::shared_ptr<Type> type) {
+	if (!type)
+		return 0;
+
+	switch (type->getBasetype()) {
+	case Type::INT: {
+		int width = std::static_pointer_cast<TypeInt>(type)->getWidth();
+		return (width > 0) ? width : 0;
+	}
+	case Type::CLOCK:
+		return 1;
+	case Type::VECTOR: {
+		auto vector = std::static_pointer_cast<TypeVector>(type);
+		int size = vector->getSize();
+		return (size > 0) ? size * bits(vector->getType()) : 0;
+	}
+	case Type::BUNDLE: {
+		uint64_t sum = 0;
+		for (const auto &f : std::static_pointer_cast<TypeBundle>(type)->getFields())
+			sum += bits(f->getType());
+		return sum;
+	}
+	default:
+		return 0;
+	}
+}
+
+static void add(Hierarchy::Statistics &to, const Hierarchy::Statistics &s,
+		uint64_t factor) {
+	to.registers += factor * s.registers;
+	to.regBits += factor * s.regBits;
+	to.memories += factor * s.memories;
+	to.memoryBits += factor * s.memoryBits;
+	to.nodes += factor * s.nodes;
+	to.instances += factor * s.instances;
+}
+
+// Collects the statistics and instances of one module
+class HierarchyVisitor : public Visitor {
+public:
+	HierarchyVisitor(std::shared_ptr<Circuit> circuit)
+	: mStatistics(), mCircuit(circuit) {}
+
+	Hierarchy::Statistics mStatistics;
+	std::vector<std::shared_ptr<Module> > mInstances;
+
+	virtual bool visit(std::shared_ptr<Reg> r) {
+		mStatistics.registers++;
+		mStatistics.regBits += bits(r->getType());
+		return false;
+	}
+
+	virtual bool visit(std::shared_ptr<Memory> m) {
+		mStatistics.memories++;
+		if (m->getDepth() > 0)
+			mStatistics.memoryBits += m->getDepth() * bits(m->getDType());
+		return false;
+	}
+
+	virtual bool visit(std::shared_ptr<Node>) {
+		mStatistics.nodes++;
+		return false;
+	}
+
+	virtual bool visit(std::shared_ptr<Instance> i) {
+		mStatistics.instances++;
+		// Does not need elaboration
+		auto mod = mCircuit->getModule(i->getOf()->getToSymbol());
+		throwAssert(mod != nullptr, "Instance of unknown module: "
+				+ i->getOf()->getToString());
+		mInstances.push_back(mod);
+		return false;
+	}
+
+	// Only statements declare what is counted
+	virtual bool visit(std::shared_ptr<Wire>) { return false; }
+	virtual bool visit(std::shared_ptr<Connect>) { return false; }
+	virtual bool visit(std::shared_ptr<Invalid>) { return false; }
+	virtual bool visit(std::shared_ptr<Stop>) { return false; }
+	virtual bool visit(std::shared_ptr<Printf>) { return false; }
+	virtual bool visit(std::shared_ptr<Mux>) { return false; }
+	virtual bool visit(std::shared_ptr<PrimOp>) { return false; }
+private:
+	std::shared_ptr<Circuit> mCircuit;
+};
+
+Hierarchy::Hierarchy(std::shared_ptr<Circuit> circuit) {
+	const auto &modules = circuit->getModules();
+
+	mVertices.resize(modules.size());
+	for (size_t i = 0; i < modules.size(); i++) {
+		mVertices[i].module = modules[i];
+		mVertices[i].count = 0;
+		mIndex[modules[i].get()] = i;
+	}
+
+	// Edges with the number of instances of each module
+	std::vector<size_t> parents(modules.size(), 0);
+	for (auto &v : mVertices) {
+		HierarchyVisitor visitor(circuit);
+		if (v.module->getStmts())
+			v.module->getStmts()->accept(visitor);
+		v.local = visitor.mStatistics;
+
+		std::unordered_map<size_t, uint64_t> counts;
+		for (auto m : visitor.mInstances)
+			counts[mIndex[m.get()]]++;
+		for (auto c : counts) {
+			v.children.push_back(c);
+			parents[c.first]++;
+		}
+	}
+
+	// Kahn's algorithm, the modules without parents come first
+	std::vector<size_t> order;
+	order.reserve(modules.size());
+	for (size_t i = 0; i < modules.size(); i++) {
+		if (parents[i] == 0)
+			order.push_back(i);
+	}
+	size_t roots = order.size();
+
+	for (size_t i = 0; i < order.size(); i++) {
+		for (auto c : mVertices[order[i]].children) {
+			if (--parents[c.first] == 0)
+				order.push_back(c.first);
+		}
+	}
+
+	for (size_t i = 0; i < modules.size(); i++) {
+		throwAssert(parents[i] == 0, "Instances form a cycle through module "
+				+ modules[i]->getId());
+	}
+
+	mTop = circuit->getModule(circuit->getSymbol());
+
+	if (mTop) {
+		mVertices[mIndex[mTop.get()]].count = 1;
+	} else {
+		for (size_t i = 0; i < roots; i++)
+			mVertices[order[i]].count = 1;
+	}
+
+	// Top-down, the parents are complete before their children
+	for (auto i : order) {
+		for (auto c : mVertices[i].children)
+			mVertices[c.first].count += c.second * mVertices[i].count;
+	}
+
+	// Bottom-up, a subtree is the module and the subtrees it instantiates
+	for (auto it = order.rbegin(); it != order.rend(); ++it) {
+		Vertex &v = mVertices[*it];
+		v.total = v.local;
+		for (auto c : v.children)
+			add(v.total, mVertices[c.first].total, c.second);
+	}
+
+	mOrder.reserve(order.size());
+	for (auto i : order)
+		mOrder.push_back(mVertices[i].module);
+}
+
+Hierarchy::Vertex &Hierarchy::vertex(std::shared_ptr<Module> module) {
+	auto it = mIndex.find(module.get());
+	throwAssert(it != mIndex.end(), "Module is not in the circuit: "
+			+ module->getId());
+	return mVertices[it->second];
+}
+
+const std::vector<std::shared_ptr<Module> > &Hierarchy::getOrder() {
+	return mOrder;
+}
+
+std::shared_ptr<Module> Hierarchy::getTop() {
+	return mTop;
+}
+
+uint64_t Hierarchy::getInstanceCount(std::shared_ptr<Module> module) {
+	return vertex(module).count;
+}
+
+Hierarchy::Statistics Hierarchy::getLocal(std::shared_ptr<Module> module) {
+	return vertex(module).local;
+}
+
+Hierarchy::Statistics Hierarchy::getTotal(std::shared_ptr<Module> module) {
+	return vertex(module).total;
+}
+
+}
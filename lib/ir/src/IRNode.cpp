@@ -21,6 +21,7 @@
  */
 
 #include <IR.h>
+#include <Visitor.h>
 
 #include <iostream>
 
@@ -28,13 +29,40 @@ namespace Firrtlator {
 
 IRNode::~IRNode() {}
 
-IRNode::IRNode() : IRNode("") {}
+void IRNode::defer(std::shared_ptr<IRNode> node) {
+	// Nodes released while destroying a node are collected by the
+	// outermost destructor and destroyed one after the other
+	static thread_local std::vector<std::shared_ptr<IRNode> > *pending = nullptr;
 
-IRNode::IRNode(std::string id) : mId(id) {}
+	if (!node || (node.use_count() > 1))
+		return;
 
-std::string IRNode::getId() { return mId; }
+	if (pending) {
+		pending->push_back(std::move(node));
+		return;
+	}
+
+	std::vector<std::shared_ptr<IRNode> > nodes;
+	nodes.push_back(std::move(node));
+	pending = &nodes;
+
+	while (!nodes.empty()) {
+		std::shared_ptr<IRNode> n = std::move(nodes.back());
+		nodes.pop_back();
+	}
+
+	pending = nullptr;
+}
+
+IRNode::IRNode(NodeKind kind) : IRNode(kind, "") {}
+
+IRNode::IRNode(NodeKind kind, Symbol id) : mId(id), mKind(kind) {}
+
+const std::string &IRNode::getId() { return mId; }
 
-void IRNode::setId(std::string id) { mId = id; }
+Symbol IRNode::getSymbol() { return mId; }
+
+void IRNode::setId(Symbol id) { mId = id; }
 
 std::shared_ptr<Info> IRNode::getInfo() { return mInfo; }
 
@@ -42,18 +70,101 @@ void IRNode::setInfo(std::shared_ptr<Info> info) {
 	mInfo = info;
 }
 
-bool IRNode::isDeclaration() { return (mId.length() != 0); }
+bool IRNode::isDeclaration() { return !mId.empty(); }
+
+void IRNode::accept(Visitor& v) {
+	walk(*this, v);
+}
+
+void IRNode::accept(RefVisitor& v) {
+	walk(*this, v);
+}
 
-Info::Info(std::string value) : mValue(value) {}
+Info::Info(std::string value) {
+	parse(value.data(), value.data() + value.size());
+}
 
-void Info::setValue(std::string value) { mValue = value; }
+Info::Info(const char *begin, const char *end) {
+	parse(begin, end);
+}
 
-std::string Info::getValue() { return mValue; }
+Info::Info(Symbol file, unsigned line, unsigned column)
+: mText(file), mLine(line), mColumn(column), mLocation(1) {}
+
+static bool parseNumber(const char *begin, const char *end, uint32_t max,
+		uint32_t &value) {
+	// Leading zeros would not survive printing the number
+	if ((begin == end) || ((*begin == '0') && (end - begin > 1)))
+		return false;
+
+	uint64_t v = 0;
+	for (const char *p = begin; p != end; p++) {
+		if ((*p < '0') || (*p > '9'))
+			return false;
+		v = v * 10 + (*p - '0');
+		if (v > max)
+			return false;
+	}
+
+	value = v;
+	return true;
+}
+
+void Info::parse(const char *begin, const char *end) {
+	const char *space = std::find(begin, end, ' ');
+	const char *colon = std::find(space, end, ':');
+	uint32_t line, column;
+
+	mLocation = 0;
+	mLine = 0;
+	mColumn = 0;
+
+	if ((space != begin) && (space != end) && (colon != end)
+			&& parseNumber(space + 1, colon, UINT32_MAX, line)
+			&& parseNumber(colon + 1, end, INT32_MAX, column)) {
+		mText = Symbol(begin, space);
+		mLine = line;
+		mColumn = column;
+		mLocation = 1;
+	} else {
+		mText = Symbol(begin, end);
+	}
+}
+
+void Info::setValue(std::string value) {
+	parse(value.data(), value.data() + value.size());
+}
+
+std::string Info::getValue() const {
+	if (!mLocation)
+		return mText;
+
+	return mText.str() + " " + std::to_string(mLine) + ":"
+			+ std::to_string(mColumn);
+}
+
+void Info::print(std::ostream &os) const {
+	os << mText;
+	if (mLocation)
+		os << " " << mLine << ":" << mColumn;
+}
+
+bool Info::operator==(const Info &other) const {
+	return (mText == other.mText) && (mLine == other.mLine)
+			&& (mColumn == other.mColumn) && (mLocation == other.mLocation);
+}
+
+size_t Info::hash() const {
+	return mText.hash() ^ ((((size_t) mLine * 1000003 + mColumn) << 1)
+			| mLocation);
+}
 
 std::ostream& operator<< (std::ostream &os, const Info &info)
 {
-	if (info.mValue.length() > 0) {
-		os << " @[" << info.mValue << "] ";
+	if (info.mLocation || !info.mText.empty()) {
+		os << " @[";
+		info.print(os);
+		os << "] ";
 	}
     return os;
 }
@@ -26,7 +26,7 @@
 
 namespace Firrtlator {
 
-Memory::Memory(std::string id) : Stmt(id) {}
+Memory::Memory(Symbol id) : Stmt(NodeKind::Memory, id) {}
 
 void Memory::setDType(std::shared_ptr<Type> type) {
 	throwAssert((type != nullptr), "Invalid memory type");
@@ -46,7 +46,7 @@ void Memory::setReadLatency(int lat) {
 	throwAssert((lat >= 0), "Invalid memory read latency");
 	throwAssert((mReadlatency == -1), "Memory read latency already set");
 
-	mDepth = lat;
+	mReadlatency = lat;
 }
 
 void Memory::setWriteLatency(int lat) {
@@ -101,15 +101,15 @@ std::shared_ptr<TypeBundle> Memory::getType() {
 	return mType;
 }
 
-std::vector<std::string> Memory::getReaders() {
+const std::vector<std::string> &Memory::getReaders() {
 	return mReaders;
 }
 
-std::vector<std::string> Memory::getWriters() {
+const std::vector<std::string> &Memory::getWriters() {
 	return mWriters;
 }
 
-std::vector<std::string> Memory::getReadWriters() {
+const std::vector<std::string> &Memory::getReadWriters() {
 	return mReadWriters;
 }
 
@@ -137,13 +137,13 @@ bool Memory::checkAndUpdateDeferedType() {
 	if (mType != nullptr)
 		return true;
 
-	mType = std::make_shared<TypeBundle>();
+	mType = make_node<TypeBundle>();
 
-	for (auto r : mReaders)
+	for (const auto &r : mReaders)
 		addReaderToType(r);
-	for (auto w : mWriters)
+	for (const auto &w : mWriters)
 		addWriterToType(w);
-	for (auto rw : mReadWriters)
+	for (const auto &rw : mReadWriters)
 		addReadWriterToType(rw);
 
 	return true;
@@ -151,46 +151,42 @@ bool Memory::checkAndUpdateDeferedType() {
 
 void Memory::addReaderToType(std::string r) {
 	std::shared_ptr<TypeBundle> bundle;
-	bundle = std::make_shared<TypeBundle>();
-	//bundle->addField(std::make_shared<Field>("data", TODO, true)); // Copy constructor
-	//bundle->addField(std::make_shared<Field>("addr", TODO)); // Width inference
-	bundle->addField(std::make_shared<Field>("en",
-			std::make_shared<TypeInt>(false, 1)));
-	bundle->addField(std::make_shared<Field>("clk",
-			std::make_shared<TypeClock>()));
-	mType->addField(std::make_shared<Field>(r, bundle));
+	bundle = make_node<TypeBundle>();
+	//bundle->addField(make_node<Field>("data", TODO, true)); // Copy constructor
+	//bundle->addField(make_node<Field>("addr", TODO)); // Width inference
+	bundle->addField(make_node<Field>("en",
+			make_node<TypeInt>(false, 1)));
+	bundle->addField(make_node<Field>("clk",
+			make_node<TypeClock>()));
+	mType->addField(make_node<Field>(r, bundle));
 }
 
 void Memory::addWriterToType(std::string w) {
 	std::shared_ptr<TypeBundle> bundle;
-	bundle = std::make_shared<TypeBundle>();
-	//bundle->addField(std::make_shared<Field>("data", TODO, true)); // Copy constructor
-	//bundle->addField(std::make_shared<Field>("mask", TODO, true)); // Inference
-	//bundle->addField(std::make_shared<Field>("addr", TODO)); // Width inference
-	bundle->addField(std::make_shared<Field>("en",
-			std::make_shared<TypeInt>(false, 1)));
-	bundle->addField(std::make_shared<Field>("clk",
-			std::make_shared<TypeClock>()));
-	mType->addField(std::make_shared<Field>(w, bundle));
+	bundle = make_node<TypeBundle>();
+	//bundle->addField(make_node<Field>("data", TODO, true)); // Copy constructor
+	//bundle->addField(make_node<Field>("mask", TODO, true)); // Inference
+	//bundle->addField(make_node<Field>("addr", TODO)); // Width inference
+	bundle->addField(make_node<Field>("en",
+			make_node<TypeInt>(false, 1)));
+	bundle->addField(make_node<Field>("clk",
+			make_node<TypeClock>()));
+	mType->addField(make_node<Field>(w, bundle));
 }
 
 void Memory::addReadWriterToType(std::string rw) {
 	std::shared_ptr<TypeBundle> bundle;
-	bundle = std::make_shared<TypeBundle>();
-	//bundle->addField(std::make_shared<Field>("data", TODO, true)); // Copy constructor
-	//bundle->addField(std::make_shared<Field>("mask", TODO, true)); // Inference
-	//bundle->addField(std::make_shared<Field>("addr", TODO)); // Width inference
-	bundle->addField(std::make_shared<Field>("en",
-			std::make_shared<TypeInt>(false, 1)));
-	bundle->addField(std::make_shared<Field>("clk",
-			std::make_shared<TypeClock>()));
-	bundle->addField(std::make_shared<Field>("wmode",
-			std::make_shared<TypeInt>(false, 1)));
-	mType->addField(std::make_shared<Field>(rw, bundle));
-}
-
-void Memory::accept(Visitor& v) {
-	v.visit(shared_from_base<Memory>());
+	bundle = make_node<TypeBundle>();
+	//bundle->addField(make_node<Field>("data", TODO, true)); // Copy constructor
+	//bundle->addField(make_node<Field>("mask", TODO, true)); // Inference
+	//bundle->addField(make_node<Field>("addr", TODO)); // Width inference
+	bundle->addField(make_node<Field>("en",
+			make_node<TypeInt>(false, 1)));
+	bundle->addField(make_node<Field>("clk",
+			make_node<TypeClock>()));
+	bundle->addField(make_node<Field>("wmode",
+			make_node<TypeInt>(false, 1)));
+	mType->addField(make_node<Field>(rw, bundle));
 }
 
 }
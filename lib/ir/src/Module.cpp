@@ -29,8 +29,8 @@
 namespace Firrtlator {
 
 Module::Module() : Module("") {}
-Module::Module(std::string id, bool external)
-: IRNode(id), mExternal(external) {}
+Module::Module(Symbol id, bool external)
+: IRNode(NodeKind::Module, id), mExternal(external) {}
 
 void Module::addPort(std::shared_ptr<Port> port) {
 	mPorts.push_back(port);
@@ -38,6 +38,17 @@ void Module::addPort(std::shared_ptr<Port> port) {
 
 void Module::setStatementGroup(std::shared_ptr<StmtGroup> stmts) {
 	mStmts = stmts;
+	mLoader = nullptr;
+}
+
+void Module::setStatementLoader(
+		std::function<std::shared_ptr<StmtGroup>()> loader) {
+	mStmts = nullptr;
+	mLoader = loader;
+}
+
+bool Module::isLoaded() {
+	return !mLoader;
 }
 
 void Module::setDefname(std::string defname) {
@@ -59,29 +70,21 @@ std::string Module::getDefname() {
 	return mDefname;
 }
 
-std::vector<std::shared_ptr<Port> > Module::getPorts() {
+const std::vector<std::shared_ptr<Port> > &Module::getPorts() {
 	return mPorts;
 }
 
 std::shared_ptr<StmtGroup> Module::getStmts() {
+	if (mLoader) {
+		mStmts = mLoader();
+		mLoader = nullptr;
+	}
+
 	return mStmts;
 }
 
-std::vector<std::shared_ptr<Parameter> > Module::getParameters() {
+const std::vector<std::shared_ptr<Parameter> > &Module::getParameters() {
 	return mParameters;
 }
 
-void Module::accept(Visitor& v) {
-	if (!v.visit(shared_from_base<Module>()))
-		return;
-
-	for (auto p : mPorts)
-		p->accept(v);
-
-	if (mStmts)
-		mStmts->accept(v);
-
-	v.leave(shared_from_base<Module>());
-}
-
 }
@@ -25,12 +25,8 @@
 
 namespace Firrtlator {
 
-Parameter::Parameter() {
+Parameter::Parameter() : IRNode(NodeKind::Parameter) {
 
 }
 
-void Parameter::accept(Visitor& v) {
-	v.visit(shared_from_base<Parameter>());
-}
-
 }
@@ -28,8 +28,8 @@ namespace Firrtlator {
 
 Port::Port() : Port("", INPUT, nullptr) { }
 
-Port::Port(std::string id, Direction dir, std::shared_ptr<Type> type)
-: IRNode(id), mDirection(dir), mType(type) {}
+Port::Port(Symbol id, Direction dir, std::shared_ptr<Type> type)
+: IRNode(NodeKind::Port, id), mDirection(dir), mType(type) {}
 
 void Port::setDirection(Direction dir) {
 	mDirection = dir;
@@ -39,13 +39,8 @@ Port::Direction Port::getDirection() {
 	return mDirection;
 }
 
-void Port::accept(Visitor& v) {
-	if (!v.visit(shared_from_base<Port>()))
-		return;
-
-	mType->accept(v);
-
-	v.leave(shared_from_base<Port>());
+std::shared_ptr<Type> Port::getType() {
+	return mType;
 }
 
 }
@@ -27,21 +27,26 @@
 
 namespace Firrtlator {
 
-Stmt::Stmt() : Stmt("") {}
+Stmt::Stmt(NodeKind kind) : Stmt(kind, "") {}
 
-Stmt::Stmt(std::string id) : IRNode(id) {}
+Stmt::Stmt(NodeKind kind, Symbol id) : IRNode(kind, id) {}
 
-StmtGroup::StmtGroup() {}
+StmtGroup::StmtGroup() : Stmt(NodeKind::StmtGroup) {}
 
-StmtGroup::StmtGroup(std::shared_ptr<Stmt> stmt) {
+StmtGroup::StmtGroup(std::shared_ptr<Stmt> stmt)
+: Stmt(NodeKind::StmtGroup) {
 	mGroup.push_back(stmt);
 }
 
-
-StmtGroup::StmtGroup(std::vector<std::shared_ptr<Stmt> > group) {
+StmtGroup::StmtGroup(std::vector<std::shared_ptr<Stmt> > group)
+: Stmt(NodeKind::StmtGroup) {
 	mGroup = group;
 }
 
+StmtGroup::~StmtGroup() {
+	release(mGroup);
+}
+
 void StmtGroup::addStatement(std::shared_ptr<Stmt> stmt) {
 	mGroup.push_back(stmt);
 }
@@ -54,40 +59,20 @@ StmtGroup::iterator StmtGroup::end() {
 	return mGroup.end();
 }
 
-void StmtGroup::accept(Visitor& v) {
-	if (!v.visit(shared_from_base<StmtGroup>()))
-		return;
-
-	for (auto s : mGroup)
-		s->accept(v);
-
-	v.leave(shared_from_base<StmtGroup>());
-}
-
-
 Wire::Wire() : Wire("", nullptr) {}
 
-Wire::Wire(std::string id, std::shared_ptr<Type> type)
-: Stmt(id), mType(type) {}
+Wire::Wire(Symbol id, std::shared_ptr<Type> type)
+: Stmt(NodeKind::Wire, id), mType(type) {}
 
 std::shared_ptr<Type> Wire::getType() {
 	return mType;
 }
 
-void Wire::accept(Visitor& v) {
-	if(!v.visit(shared_from_base<Wire>()))
-		return;
-
-	mType->accept(v);
-
-	v.leave(shared_from_base<Wire>());
-}
-
 Reg::Reg() : Reg("", nullptr, nullptr) {}
 
-Reg::Reg(std::string id, std::shared_ptr<Type> type,
+Reg::Reg(Symbol id, std::shared_ptr<Type> type,
 		std::shared_ptr<Expression> clock)
-: Stmt(id), mType(type), mClock(clock) {}
+: Stmt(NodeKind::Reg, id), mType(type), mClock(clock) {}
 
 std::shared_ptr<Type> Reg::getType() {
 	return mType;
@@ -97,21 +82,6 @@ std::shared_ptr<Expression> Reg::getClock() {
 	return mClock;
 }
 
-void Reg::accept(Visitor& v) {
-	if (!v.visit(shared_from_base<Reg>()))
-		return;
-
-	mType->accept(v);
-	mClock->accept(v);
-
-	if (mResetTrigger && mResetValue) {
-		mResetTrigger->accept(v);
-		mResetValue->accept(v);
-	}
-
-	v.leave(shared_from_base<Circuit>());
-}
-
 void Reg::setResetTrigger(std::shared_ptr<Expression> trigger) {
 	mResetTrigger = trigger;
 }
@@ -128,49 +98,36 @@ std::shared_ptr<Expression> Reg::getResetValue() {
 	return mResetValue;
 }
 
-
 Instance::Instance() : Instance("", nullptr) {}
 
-Instance::Instance(std::string id, std::shared_ptr<Reference> of)
-: Stmt(id), mOf(of) {}
+Instance::Instance(Symbol id, std::shared_ptr<Reference> of)
+: Stmt(NodeKind::Instance, id), mOf(of) {}
 
 std::shared_ptr<Reference> Instance::getOf() {
 	return mOf;
 }
 
-void Instance::accept(Visitor& v) {
-	if (!v.visit(shared_from_base<Instance>()))
-		return;
-
-	mOf->accept(v);
-
-	v.leave(shared_from_base<Instance>());
+std::shared_ptr<Module> Instance::getModule() {
+	if (!mOf)
+		return nullptr;
+	return std::static_pointer_cast<Module>(mOf->getTo());
 }
 
 Node::Node() : Node("", nullptr) {}
 
-Node::Node(std::string id, std::shared_ptr<Expression> expr)
-: Stmt(id), mExpr(expr) {}
+Node::Node(Symbol id, std::shared_ptr<Expression> expr)
+: Stmt(NodeKind::Node, id), mExpr(expr) {}
 
 std::shared_ptr<Expression> Node::getExpression() {
 	return mExpr;
 }
 
-void Node::accept(Visitor& v) {
-	if (!v.visit(shared_from_base<Node>()))
-		return;
-
-	mExpr->accept(v);
-
-	v.leave(shared_from_base<Node>());
-}
-
 Connect::Connect() : Connect(nullptr, nullptr) {}
 
 Connect::Connect(std::shared_ptr<Expression> to,
 		std::shared_ptr<Expression> from,
 		bool partial)
-: mTo(to), mFrom(from), mPartial(partial) {}
+: Stmt(NodeKind::Connect), mTo(to), mFrom(from), mPartial(partial) {}
 
 bool Connect::getPartial() {
 	return mPartial;
@@ -184,38 +141,25 @@ std::shared_ptr<Expression> Connect::getFrom() {
 	return mFrom;
 }
 
-void Connect::accept(Visitor& v) {
-	if (!v.visit(shared_from_base<Connect>()))
-		return;
-
-	mTo->accept(v);
-	mFrom->accept(v);
-
-	v.leave(shared_from_base<Connect>());
-}
-
 Invalid::Invalid() : Invalid(nullptr) {}
 
 Invalid::Invalid(std::shared_ptr<Expression> exp)
-: mExp(exp) {}
+: Stmt(NodeKind::Invalid), mExp(exp) {}
 
 std::shared_ptr<Expression> Invalid::getExpr() {
 	return mExp;
 }
 
-void Invalid::accept(Visitor& v) {
-	if (!v.visit(shared_from_base<Invalid>()))
-		return;
-
-	mExp->accept(v);
-
-	v.leave(shared_from_base<Invalid>());
-}
-
 Conditional::Conditional() : Conditional(nullptr) {}
 
 Conditional::Conditional(std::shared_ptr<Expression> cond)
-: mCond(cond) {}
+: Stmt(NodeKind::Conditional), mCond(cond) {}
+
+Conditional::~Conditional() {
+	release(mCond);
+	release(mThen);
+	release(mElse);
+}
 
 void Conditional::setThen(std::shared_ptr<StmtGroup> stmt) {
 	mThen = stmt;
@@ -237,25 +181,15 @@ std::shared_ptr<ConditionalElse> Conditional::getElse() {
 	return mElse;
 }
 
-void Conditional::accept(Visitor& v) {
-	if (!v.visit(shared_from_base<Conditional>()))
-		return;
-
-	mCond->accept(v);
+ConditionalElse::ConditionalElse() : IRNode(NodeKind::ConditionalElse) {}
 
-	mThen->accept(v);
-
-	if (mElse)
-		mElse->accept(v);
+ConditionalElse::ConditionalElse(std::shared_ptr<StmtGroup> stmts)
+: IRNode(NodeKind::ConditionalElse), mStmts(stmts) {}
 
-	v.leave(shared_from_base<Conditional>());
+ConditionalElse::~ConditionalElse() {
+	release(mStmts);
 }
 
-ConditionalElse::ConditionalElse() {}
-
-ConditionalElse::ConditionalElse(std::shared_ptr<StmtGroup> stmts)
-: mStmts(stmts) {}
-
 void ConditionalElse::setStmts(std::shared_ptr<StmtGroup> stmt) {
 	mStmts = stmt;
 }
@@ -264,21 +198,12 @@ std::shared_ptr<StmtGroup> ConditionalElse::getStmts() {
 	return mStmts;
 }
 
-void ConditionalElse::accept(Visitor& v) {
-	if (!v.visit(shared_from_base<ConditionalElse>()))
-		return;
-
-	mStmts->accept(v);
-
-	v.leave(shared_from_base<ConditionalElse>());
-}
-
 Stop::Stop() : Stop(nullptr, nullptr, -1) {}
 
 Stop::Stop(std::shared_ptr<Expression> clock,
 		std::shared_ptr<Expression> cond,
 		int code)
-: mClock(clock), mCond(cond), mCode(code) {}
+: Stmt(NodeKind::Stop), mClock(clock), mCond(cond), mCode(code) {}
 
 std::shared_ptr<Expression> Stop::getClock() {
 	return mClock;
@@ -292,21 +217,11 @@ int Stop::getCode() {
 	return mCode;
 }
 
-void Stop::accept(Visitor& v) {
-	if (!v.visit(shared_from_base<Stop>()))
-		return;
-
-	mClock->accept(v);
-	mCond->accept(v);
-
-	v.leave(shared_from_base<Stop>());
-}
-
 Printf::Printf() : Printf(nullptr, nullptr, "") {}
 Printf::Printf(std::shared_ptr<Expression> clock,
 		std::shared_ptr<Expression> cond,
 		std::string format)
-: mClock(clock), mCond(cond), mFormat(format) {}
+: Stmt(NodeKind::Printf), mClock(clock), mCond(cond), mFormat(format) {}
 void Printf::addArgument(std::shared_ptr<Expression> arg) {
 	mArguments.push_back(arg);
 }
@@ -323,26 +238,10 @@ std::string Printf::getFormat() {
 	return mFormat;
 }
 
-std::vector<std::shared_ptr<Expression> > Printf::getArguments() {
+const std::vector<std::shared_ptr<Expression> > &Printf::getArguments() {
 	return mArguments;
 }
 
-void Printf::accept(Visitor& v) {
-	if (!v.visit(shared_from_base<Printf>()))
-		return;
-
-	mClock->accept(v);
-	mCond->accept(v);
-
-	for (auto a : mArguments)
-		a->accept(v);
-
-	v.leave(shared_from_base<Printf>());
-}
-
-void Empty::accept(Visitor& v) {
-	v.visit(shared_from_base<Empty>());
-}
-
+Empty::Empty() : Stmt(NodeKind::Empty) {}
 
 }
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Symbol.h"
+
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace Firrtlator {
+
+namespace {
+
+// Key into the table that references the characters without owning them
+struct Key {
+	const char *str;
+	size_t len;
+
+	bool operator==(const Key &other) const {
+		return (len == other.len) && (memcmp(str, other.str, len) == 0);
+	}
+};
+
+struct KeyHash {
+	size_t operator()(const Key &k) const {
+		// FNV-1a
+		size_t h = 14695981039346656037ULL;
+		for (size_t i = 0; i < k.len; i++) {
+			h ^= (unsigned char) k.str[i];
+			h *= 1099511628211ULL;
+		}
+		return h;
+	}
+};
+
+// The table is split in shards with their own lock, so that parallel
+// parsers rarely wait for each other
+struct Shard {
+	std::mutex mutex;
+	std::deque<std::string> strings;
+	std::unordered_map<Key, const std::string*, KeyHash> map;
+};
+
+const size_t numShards = 16;
+
+// Recently used symbols of each thread, checked before taking the lock
+struct CacheEntry {
+	size_t hash;
+	const std::string *str;
+};
+
+const size_t cacheSize = 4096;
+
+Shard *getShards() {
+	static Shard shards[numShards];
+	return shards;
+}
+
+}
+
+const std::string *Symbol::intern(const char *str, size_t len) {
+	Key key = { str, len };
+	size_t h = KeyHash()(key);
+
+	static thread_local CacheEntry cache[cacheSize];
+	CacheEntry &entry = cache[h % cacheSize];
+	if (entry.str && (entry.hash == h) && (entry.str->size() == len)
+			&& (memcmp(entry.str->data(), str, len) == 0))
+		return entry.str;
+
+	Shard &shard = getShards()[h % numShards];
+	std::lock_guard<std::mutex> lock(shard.mutex);
+
+	auto it = shard.map.find(key);
+	if (it == shard.map.end()) {
+		// The deque never moves its elements, the key can point into it
+		shard.strings.emplace_back(str, len);
+		const std::string *s = &shard.strings.back();
+		it = shard.map.emplace(Key { s->data(), len }, s).first;
+	}
+
+	entry.hash = h;
+	entry.str = it->second;
+
+	return it->second;
+}
+
+Symbol::Symbol() {
+	static const std::string *empty = intern("", 0);
+	mString = empty;
+}
+
+Symbol::Symbol(const std::string &str)
+: mString(intern(str.data(), str.size())) {}
+
+Symbol::Symbol(const char *str) : mString(intern(str, strlen(str))) {}
+
+Symbol::Symbol(const char *begin, const char *end)
+: mString(intern(begin, end - begin)) {}
+
+std::ostream& operator<< (std::ostream &os, const Symbol &s) {
+	return os << s.str();
+}
+
+}
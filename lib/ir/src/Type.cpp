@@ -26,14 +26,19 @@
 
 namespace Firrtlator {
 
-Type::Type() : mBasetype(UNDEFINED) {}
+Type::Type(NodeKind kind) : IRNode(kind), mBasetype(UNDEFINED) {}
 
-Type::Type(Basetype type) : mBasetype(type) {}
+Type::Type(NodeKind kind, Basetype type)
+: IRNode(kind), mBasetype(type) {}
+
+Type::Basetype Type::getBasetype() {
+	return mBasetype;
+}
 
 TypeInt::TypeInt() : TypeInt(false) {}
 
 TypeInt::TypeInt(bool sign, int width)
-: Type(INT), mWidth(width), mSigned(sign) {}
+: Type(NodeKind::TypeInt, INT), mWidth(width), mSigned(sign) {}
 
 void TypeInt::setWidth(int width) {
 	mWidth = width;
@@ -51,20 +56,16 @@ void TypeInt::setSigned(bool sign) {
 	mSigned = sign;
 }
 
-void TypeInt::accept(Visitor& v) {
-	v.visit(shared_from_base<TypeInt>());
-}
+TypeClock::TypeClock() : Type(NodeKind::TypeClock, CLOCK) { }
 
-TypeClock::TypeClock() : Type(CLOCK) { }
+Field::Field() : Field("", nullptr) {}
+Field::Field(Symbol id, std::shared_ptr<Type> type, bool flip)
+: IRNode(NodeKind::Field, id), mFlip(flip), mType(type) {}
 
-void TypeClock::accept(Visitor& v) {
-	v.visit(shared_from_base<TypeClock>());
+Field::~Field() {
+	release(mType);
 }
 
-Field::Field() : Field("", nullptr) {}
-Field::Field(std::string id, std::shared_ptr<Type> type, bool flip)
-: IRNode(id), mFlip(flip), mType(type) {}
-
 void Field::setType(std::shared_ptr<Type> t) {
 	mType = t;
 }
@@ -81,24 +82,36 @@ bool Field::getFlip() {
 	return mFlip;
 }
 
-void Field::accept(Visitor& v) {
-	v.visit(shared_from_base<Field>());
+TypeBundle::TypeBundle() : Type(NodeKind::TypeBundle, BUNDLE) {}
+
+TypeBundle::~TypeBundle() {
+	release(mFields);
 }
 
-TypeBundle::TypeBundle() : Type(BUNDLE) {}
 void TypeBundle::addField(std::shared_ptr<Field> field) {
 	mFields.push_back(field);
 }
 
-std::vector<std::shared_ptr<Field> > TypeBundle::getFields() {
+const std::vector<std::shared_ptr<Field> > &TypeBundle::getFields() {
 	return mFields;
 }
 
-void TypeBundle::accept(Visitor& v) {
+TypeVector::TypeVector() : Type(NodeKind::TypeVector, VECTOR), mSize(0) { }
 
+TypeVector::TypeVector(std::shared_ptr<Type> type, int size)
+: Type(NodeKind::TypeVector, VECTOR), mType(type), mSize(size) { }
+
+TypeVector::~TypeVector() {
+	release(mType);
 }
 
-TypeVector::TypeVector() : Type(VECTOR), mSize(0) { }
+void TypeVector::setType(std::shared_ptr<Type> type) {
+	mType = type;
+}
+
+std::shared_ptr<Type> TypeVector::getType() {
+	return mType;
+}
 
 void TypeVector::setSize(int size) {
 	mSize = size;
@@ -108,9 +121,5 @@ int TypeVector::getSize() {
 	return mSize;
 }
 
-void TypeVector::accept(Visitor& v) {
-	v.visit(shared_from_base<TypeVector>());
-}
-
 }
 
@@ -36,6 +36,9 @@ class PassBase {
 public:
     virtual ~PassBase();
     virtual void run(std::shared_ptr<Circuit>) = 0;
+    void setThreads(unsigned threads);
+protected:
+    unsigned mThreads = 1;
 };
 
 class PassFactory
@@ -29,6 +29,10 @@ PassBase::~PassBase() {
 
 }
 
+void PassBase::setThreads(unsigned threads) {
+	mThreads = (threads > 0) ? threads : 1;
+}
+
 void Registry::registerPass(const std::string &name,
 	PassFactory* factory) {
 	getPassMap()[name] = factory;
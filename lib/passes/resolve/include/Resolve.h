@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "StaticVisitor.h"
+#include "FirrtlatorPass.h"
+
+#include <unordered_map>
+
+namespace Firrtlator {
+namespace Pass {
+namespace Resolve {
+
+/*
+ * Resolves all references to their declarations. The modules are
+ * resolved in parallel, each with its own symbol table.
+ */
+class Pass : public ::Firrtlator::Pass::PassBase {
+public:
+	Pass();
+	virtual void run(std::shared_ptr<Circuit> ir);
+	static std::string name;
+	static std::string description;
+};
+
+typedef std::unordered_map<Symbol, std::shared_ptr<IRNode> > SymbolTable;
+
+/*
+ * Resolves the references of one module in a single walk. Declarations
+ * are entered when they are visited, references to declarations that
+ * follow later are resolved at the end.
+ */
+class Visitor : public StaticVisitor<Visitor> {
+public:
+	// The circuit's module index resolves the modules of instances
+	Visitor(std::shared_ptr<Circuit> circuit);
+
+	// References without declaration are left unresolved
+	void resolve(std::shared_ptr<Module> module);
+
+	bool visitPort(Port&);
+	bool visitWire(Wire&);
+	bool visitReg(Reg&);
+	bool visitInstance(Instance&);
+	bool visitMemory(Memory&);
+	bool visitNode(Node&);
+	bool visitSubField(SubField&);
+	void visitReference(Reference&);
+private:
+	std::shared_ptr<Circuit> mCircuit;
+	SymbolTable mSymbols;
+	// The module being resolved owns the pending references
+	std::vector<Reference*> mPending;
+
+	void declare(IRNode &node);
+};
+
+}
+}
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Resolve.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace Firrtlator {
+namespace Pass {
+namespace Resolve {
+
+std::string Pass::name = "resolve";
+std::string Pass::description = "Resolve references to their declarations";
+
+REGISTER_PASS(Pass)
+
+Pass::Pass() : PassBase() {
+
+}
+
+void Pass::run(std::shared_ptr<Circuit> ir) {
+	const std::vector<std::shared_ptr<Module> > &modules = ir->getModules();
+
+	for (const auto &m : modules) {
+		// Lazy bodies are loaded first, as loaders share the arena of
+		// the circuit, which is not thread-safe
+		m->getStmts();
+	}
+
+	std::atomic<size_t> next(0);
+
+	auto worker = [&] () {
+		Visitor v(ir);
+		for (size_t i = next++; i < modules.size(); i = next++)
+			v.resolve(modules[i]);
+	};
+
+	unsigned numThreads = std::min<size_t>(mThreads, modules.size());
+	std::vector<std::thread> threads;
+	for (unsigned t = 1; t < numThreads; t++)
+		threads.push_back(std::thread(worker));
+	worker();
+	for (auto &t : threads)
+		t.join();
+}
+
+Visitor::Visitor(std::shared_ptr<Circuit> circuit)
+: mCircuit(circuit) {
+
+}
+
+void Visitor::resolve(std::shared_ptr<Module> module) {
+	mSymbols.clear();
+	mPending.clear();
+
+	for (const auto &p : module->getPorts())
+		declare(*p);
+
+	if (module->getStmts())
+		traverse(module->getStmts());
+
+	for (auto r : mPending) {
+		auto it = mSymbols.find(r->getToSymbol());
+		if (it != mSymbols.end())
+			r->setTo(it->second);
+	}
+}
+
+void Visitor::declare(IRNode &node) {
+	mSymbols[node.getSymbol()] = node.shared_from_this();
+}
+
+bool Visitor::visitPort(Port &p) {
+	declare(p);
+	return false;
+}
+
+bool Visitor::visitWire(Wire &w) {
+	declare(w);
+	return false;
+}
+
+bool Visitor::visitReg(Reg &r) {
+	// Before the reset value, which often is the register itself
+	declare(r);
+	return true;
+}
+
+bool Visitor::visitInstance(Instance &i) {
+	declare(i);
+
+	// The module is not a name in the scope of this module
+	auto of = i.getOf();
+	auto mod = mCircuit->getModule(of->getToSymbol());
+	if (mod)
+		of->setTo(mod);
+
+	return false;
+}
+
+bool Visitor::visitMemory(Memory &m) {
+	declare(m);
+	return false;
+}
+
+bool Visitor::visitNode(Node &n) {
+	declare(n);
+	return true;
+}
+
+bool Visitor::visitSubField(SubField &s) {
+	// The field is a name in the type of the expression, not a declaration
+	traverse(s.getOf());
+	return false;
+}
+
+void Visitor::visitReference(Reference &r) {
+	auto it = mSymbols.find(r.getToSymbol());
+	if (it != mSymbols.end())
+		r.setTo(it->second);
+	else
+		mPending.push_back(&r);
+}
+
+}
+}
+}
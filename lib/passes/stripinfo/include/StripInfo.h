@@ -22,7 +22,7 @@
 
 #pragma once
 
-#include "Visitor.h"
+#include "StaticVisitor.h"
 #include "FirrtlatorPass.h"
 
 #include <iostream>
@@ -40,40 +40,39 @@ public:
 	static std::string description;
 };
 
-class Visitor : public ::Firrtlator::Visitor {
+class Visitor : public StaticVisitor<Visitor> {
 public:
 	Visitor();
 
-	virtual ~Visitor();
-	virtual bool visit(std::shared_ptr<Circuit>);
+	bool visitCircuit(Circuit&);
 
-	virtual bool visit(std::shared_ptr<Module>);
+	bool visitModule(Module&);
 
-	virtual bool visit(std::shared_ptr<Port>);
+	bool visitPort(Port&);
 
-	virtual bool visit(std::shared_ptr<Wire>);
+	bool visitWire(Wire&);
 
-	virtual bool visit(std::shared_ptr<Reg>);
+	bool visitReg(Reg&);
 
-	virtual bool visit(std::shared_ptr<Instance>);
+	bool visitInstance(Instance&);
 
-	virtual bool visit(std::shared_ptr<Memory>);
+	bool visitMemory(Memory&);
 
-	virtual bool visit(std::shared_ptr<Node>);
+	bool visitNode(Node&);
 
-	virtual bool visit(std::shared_ptr<Connect>);
+	bool visitConnect(Connect&);
 
-	virtual bool visit(std::shared_ptr<Invalid>);
+	bool visitInvalid(Invalid&);
 
-	virtual bool visit(std::shared_ptr<Conditional>);
+	bool visitConditional(Conditional&);
 
-	virtual bool visit(std::shared_ptr<ConditionalElse>);
+	bool visitConditionalElse(ConditionalElse&);
 
-	virtual bool visit(std::shared_ptr<Stop>);
+	bool visitStop(Stop&);
 
-	virtual bool visit(std::shared_ptr<Printf>);
+	bool visitPrintf(Printf&);
 
-	virtual void visit(std::shared_ptr<Empty>);
+	void visitEmpty(Empty&);
 };
 
 }
@@ -43,88 +43,84 @@ Pass::Pass() : PassBase() {
 void Pass::run(std::shared_ptr<Circuit> ir) {
 	Visitor v;
 
-	ir->accept(v);
+	v.traverse(*ir);
 }
 
 Visitor::Visitor() {
 
 }
 
-Visitor::~Visitor() {
-
-}
-
-bool Visitor::visit(std::shared_ptr<Circuit> c) {
-	c->setInfo(nullptr);
+bool Visitor::visitCircuit(Circuit &c) {
+	c.setInfo(nullptr);
 	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<Module> m) {
-	m->setInfo(nullptr);
+bool Visitor::visitModule(Module &m) {
+	m.setInfo(nullptr);
 	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<Port> p) {
-	p->setInfo(nullptr);
+bool Visitor::visitPort(Port &p) {
+	p.setInfo(nullptr);
 	return false;
 }
 
-bool Visitor::visit(std::shared_ptr<Wire> w) {
-	w->setInfo(nullptr);
+bool Visitor::visitWire(Wire &w) {
+	w.setInfo(nullptr);
 	return false;
 }
 
-bool Visitor::visit(std::shared_ptr<Reg> r) {
-	r->setInfo(nullptr);
+bool Visitor::visitReg(Reg &r) {
+	r.setInfo(nullptr);
 	return false;
 }
 
-bool Visitor::visit(std::shared_ptr<Instance> i) {
-	i->setInfo(nullptr);
+bool Visitor::visitInstance(Instance &i) {
+	i.setInfo(nullptr);
 	return false;
 }
 
-bool Visitor::visit(std::shared_ptr<Memory> m) {
-	m->setInfo(nullptr);
+bool Visitor::visitMemory(Memory &m) {
+	m.setInfo(nullptr);
 	return false;
 }
-bool Visitor::visit(std::shared_ptr<Node> n) {
-	n->setInfo(nullptr);
+bool Visitor::visitNode(Node &n) {
+	n.setInfo(nullptr);
 	return false;
 }
 
-bool Visitor::visit(std::shared_ptr<Connect> c) {
-	c->setInfo(nullptr);
+bool Visitor::visitConnect(Connect &c) {
+	c.setInfo(nullptr);
 	return false;
 }
 
-bool Visitor::visit(std::shared_ptr<Invalid> i) {
-	i->setInfo(nullptr);
+bool Visitor::visitInvalid(Invalid &i) {
+	i.setInfo(nullptr);
 	return false;
 }
 
-bool Visitor::visit(std::shared_ptr<Conditional> c) {
-	c->setInfo(nullptr);
+bool Visitor::visitConditional(Conditional &c) {
+	c.setInfo(nullptr);
 	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<ConditionalElse> c) {
-	c->setInfo(nullptr);
+bool Visitor::visitConditionalElse(ConditionalElse &c) {
+	c.setInfo(nullptr);
 	return true;
 }
 
-bool Visitor::visit(std::shared_ptr<Stop> s) {
-	s->setInfo(nullptr);
+bool Visitor::visitStop(Stop &s) {
+	s.setInfo(nullptr);
 	return false;
 }
 
-bool Visitor::visit(std::shared_ptr<Printf> p) {
-	p->setInfo(nullptr);
+bool Visitor::visitPrintf(Printf &p) {
+	p.setInfo(nullptr);
 	return false;
 }
 
-void Visitor::visit(std::shared_ptr<Empty> e) {
-	e->setInfo(nullptr);
+void Visitor::visitEmpty(Empty &e) {
+	e.setInfo(nullptr);
 }
 
 }
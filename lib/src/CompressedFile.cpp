@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "CompressedFile.h"
+
+#include <cstdio>
+#include <stdexcept>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace Firrtlator {
+
+static const struct {
+	const char *extension;
+	CompressedFile::Compression compression;
+} extensions[] = {
+	{ "gz", CompressedFile::GZIP },
+	{ "zst", CompressedFile::ZSTD },
+};
+
+static bool endsWith(const std::string &s, const std::string &suffix) {
+	return (s.size() >= suffix.size()) &&
+			(s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0);
+}
+
+CompressedFile::Compression CompressedFile::getCompression(
+		const std::string &filename) {
+	for (auto e : extensions) {
+		if (endsWith(filename, std::string(".") + e.extension))
+			return e.compression;
+	}
+	return NONE;
+}
+
+std::string CompressedFile::stripExtension(const std::string &type) {
+	for (auto e : extensions) {
+		std::string ext = std::string(".") + e.extension;
+		if (endsWith(type, ext))
+			return type.substr(0, type.size() - ext.size());
+	}
+	return type;
+}
+
+CompressedFile::CompressedFile(std::string filename,
+		Compression compression)
+: mCompression(compression), mFile(nullptr), mStream(nullptr),
+  mInputPos(0), mInputSize(0), mFrameOpen(false), mEnd(false) {
+	switch (compression) {
+#ifdef HAVE_ZLIB
+	case GZIP: {
+		gzFile gz = gzopen(filename.c_str(), "rb");
+		if (gz) {
+			// Larger reads than the default 8k
+			gzbuffer(gz, 1 << 17);
+			mFile = gz;
+		}
+		break;
+	}
+#endif
+#ifdef HAVE_ZSTD
+	case ZSTD: {
+		FILE *f = fopen(filename.c_str(), "rb");
+		if (!f)
+			break;
+		ZSTD_DStream *stream = ZSTD_createDStream();
+		if (!stream) {
+			fclose(f);
+			break;
+		}
+		ZSTD_initDStream(stream);
+		mInput.resize(ZSTD_DStreamInSize());
+		mFile = f;
+		mStream = stream;
+		break;
+	}
+#endif
+	default:
+		break;
+	}
+}
+
+CompressedFile::~CompressedFile() {
+	if (!mFile)
+		return;
+
+	switch (mCompression) {
+#ifdef HAVE_ZLIB
+	case GZIP:
+		gzclose((gzFile) mFile);
+		break;
+#endif
+#ifdef HAVE_ZSTD
+	case ZSTD:
+		ZSTD_freeDStream((ZSTD_DStream*) mStream);
+		fclose((FILE*) mFile);
+		break;
+#endif
+	default:
+		break;
+	}
+}
+
+bool CompressedFile::isOpen() {
+	return mFile != nullptr;
+}
+
+size_t CompressedFile::read(char *buffer, size_t size) {
+	if (!mFile || mEnd || (size == 0))
+		return 0;
+
+	switch (mCompression) {
+#ifdef HAVE_ZLIB
+	case GZIP: {
+		// gzread handles concatenated members
+		int n = gzread((gzFile) mFile, buffer,
+				size > (1u << 30) ? (1u << 30) : (unsigned) size);
+		int err = Z_OK;
+		const char *msg = gzerror((gzFile) mFile, &err);
+		if ((n < 0) || ((n == 0) && (err == Z_BUF_ERROR)))
+			throw std::runtime_error(n < 0 ? msg : "Truncated input");
+		mEnd = (n == 0);
+		return n;
+	}
+#endif
+#ifdef HAVE_ZSTD
+	case ZSTD: {
+		ZSTD_outBuffer out = { buffer, size, 0 };
+
+		while (out.pos == 0) {
+			if (mInputPos == mInputSize) {
+				mInputSize = fread(&mInput[0], 1, mInput.size(),
+						(FILE*) mFile);
+				mInputPos = 0;
+				if (mInputSize == 0) {
+					if (mFrameOpen)
+						throw std::runtime_error("Truncated input");
+					mEnd = true;
+					break;
+				}
+			}
+
+			ZSTD_inBuffer in = { mInput.data(), mInputSize, mInputPos };
+			size_t ret = ZSTD_decompressStream((ZSTD_DStream*) mStream,
+					&out, &in);
+			if (ZSTD_isError(ret))
+				throw std::runtime_error(ZSTD_getErrorName(ret));
+			// Zero when a frame is complete
+			mFrameOpen = (ret != 0);
+			mInputPos = in.pos;
+		}
+
+		return out.pos;
+	}
+#endif
+	default:
+		return 0;
+	}
+}
+
+}
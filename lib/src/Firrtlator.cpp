@@ -22,17 +22,504 @@
 
 #include <Firrtlator.h>
 #include <IR.h>
+#include <StaticVisitor.h>
+#include <Hierarchy.h>
+#include <MappedFile.h>
+#include <CompressedFile.h>
+#include <ParseCache.h>
+#include <Hash.h>
 #include "FirrtlatorFrontend.h"
+#include "FirrtlatorScanner.h"
 #include "FirrtlatorPass.h"
 #include "FirrtlatorBackend.h"
+#include "FirbBackend.h"
+#include "Resolve.h"
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace Firrtlator {
 
+namespace {
+
+// Binds the instances to the modules of the circuit's module index
+class InstanceBinder : public StaticVisitor<InstanceBinder> {
+public:
+	InstanceBinder(std::shared_ptr<Circuit> circuit) : mCircuit(circuit) {}
+
+	bool visitInstance(Instance &i) {
+		auto of = i.getOf();
+		auto mod = mCircuit->getModule(of->getToSymbol());
+		if (mod)
+			of->setTo(mod);
+		return false;
+	}
+private:
+	std::shared_ptr<Circuit> mCircuit;
+};
+
+}
+
 class Firrtlator::impl {
 public:
 	std::shared_ptr<Circuit> mIR;
+	unsigned mThreads = 1;
+	std::unique_ptr<ParseCache> mCache;
+
+	// State of the last parse for incremental parsing
+	bool mIncremental = false;
+	std::string mType;
+	uint64_t mHeaderHash = 0;
+	std::vector<uint64_t> mModuleHashes;
+	std::vector<std::string> mParsed;
+	// The circuit the references were last resolved in
+	std::weak_ptr<Circuit> mResolved;
+
+	bool parse(const char *buffer, size_t size, std::string type,
+			std::shared_ptr<const void> owner);
+	bool parseIncremental(const char *buffer, size_t size, std::string type,
+			std::shared_ptr<const void> owner);
+	bool parseCached(const char *buffer, size_t size, std::string type,
+			std::shared_ptr<const void> owner);
+	bool parseCompressed(CompressedFile &file, std::string type);
+	bool parseFiles(const std::vector<std::string> &filenames,
+			std::string type);
+	std::shared_ptr<Circuit> parseFile(const std::string &filename,
+			std::string type, unsigned threads);
+	std::shared_ptr<Circuit> parseStream(CompressedFile &file,
+			std::string type, unsigned threads);
+	std::shared_ptr<Circuit> parseModule(const std::string &header,
+			const char *begin, const char *end, std::string type,
+			std::shared_ptr<Arena> arena, unsigned threads);
+	std::shared_ptr<Circuit> parseFrontend(const char *buffer, size_t size,
+			std::string type, std::shared_ptr<const void> owner,
+			std::shared_ptr<Arena> arena, unsigned threads);
 };
 
+bool Firrtlator::impl::parse(const char *buffer, size_t size,
+		std::string type, std::shared_ptr<const void> owner) {
+	// Images are not split into modules
+	if (mIncremental && (type != "FIRB"))
+		return parseIncremental(buffer, size, type, owner);
+
+	mModuleHashes.clear();
+
+	if (!parseCached(buffer, size, type, owner))
+		return false;
+
+	mParsed.clear();
+	for (const auto &m : mIR->getModules())
+		mParsed.push_back(m->getId());
+
+	return true;
+}
+
+bool Firrtlator::impl::parseIncremental(const char *buffer, size_t size,
+		std::string type, std::shared_ptr<const void> owner) {
+	const char *end = buffer + size;
+
+	// The modules are separated the same way the lazy frontend does
+	std::vector<const char*> modules = Frontend::Scanner::findModules(buffer,
+			end);
+	const char *header = modules.empty() ? end : modules[0];
+
+	uint64_t headerHash = hash64(buffer, header - buffer);
+	std::vector<uint64_t> hashes;
+	for (size_t i = 0; i < modules.size(); i++) {
+		const char *last = (i + 1 < modules.size()) ? modules[i + 1] : end;
+		hashes.push_back(hash64(modules[i], last - modules[i]));
+	}
+
+	if (!mIR || mModuleHashes.empty() || (type != mType) ||
+			(headerHash != mHeaderHash)) {
+		mModuleHashes.clear();
+
+		if (!parseCached(buffer, size, type, owner))
+			return false;
+
+		const auto &parsed = mIR->getModules();
+
+		mParsed.clear();
+		for (auto m : parsed) {
+			mParsed.push_back(m->getId());
+			// The input may be changed in place before the next parse,
+			// so the bodies of lazy frontends are loaded while it is intact
+			m->getStmts();
+		}
+
+		// Only if the modules map to the text ranges
+		if (parsed.size() == hashes.size()) {
+			mType = type;
+			mHeaderHash = headerHash;
+			mModuleHashes = hashes;
+		}
+
+		return true;
+	}
+
+	// Unchanged modules are matched by their hash, so they may move
+	std::unordered_multimap<uint64_t, std::shared_ptr<Module> > previous;
+	const auto &current = mIR->getModules();
+	for (size_t i = 0; i < current.size(); i++)
+		previous.emplace(mModuleHashes[i], current[i]);
+
+	std::vector<std::shared_ptr<Module> > result;
+	std::vector<std::string> parsed;
+
+	for (size_t i = 0; i < modules.size(); i++) {
+		auto it = previous.find(hashes[i]);
+		if (it != previous.end()) {
+			result.push_back(it->second);
+			previous.erase(it);
+			continue;
+		}
+
+		// Each module gets its own arena, which goes away with the module
+		// when it is replaced by a later edit
+		const char *last = (i + 1 < modules.size()) ? modules[i + 1] : end;
+		auto ir = parseModule(std::string(buffer, header), modules[i], last,
+				type, Arena::create(), mThreads);
+		// The circuit is kept as it was on errors
+		if (!ir)
+			return false;
+
+		auto mod = ir->getModules()[0];
+		mod->getStmts();
+		result.push_back(mod);
+		parsed.push_back(mod->getId());
+	}
+
+	mIR->setModules(result);
+	mModuleHashes = hashes;
+
+	// The instances of the modules that were kept still refer to the
+	// modules that were replaced, and the new modules are not resolved
+	if ((!parsed.empty() || !previous.empty()) && (mResolved.lock() == mIR)) {
+		std::unordered_set<std::string> added(parsed.begin(), parsed.end());
+		Pass::Resolve::Visitor resolver(mIR);
+		InstanceBinder binder(mIR);
+		for (const auto &m : result) {
+			if (added.count(m->getId()))
+				resolver.resolve(m);
+			else if (m->getStmts())
+				binder.traverse(m->getStmts());
+		}
+	}
+
+	mParsed = parsed;
+
+	return true;
+}
+
+std::shared_ptr<Circuit> Firrtlator::impl::parseModule(
+		const std::string &header, const char *begin, const char *end,
+		std::string type, std::shared_ptr<Arena> arena, unsigned threads) {
+	// Parse the module as a circuit of its own
+	std::string text = header;
+	text.append(begin, end);
+
+	auto ir = parseFrontend(text.data(), text.size(), type, nullptr, arena,
+			threads);
+	if (!ir)
+		return nullptr;
+	throwAssert(ir->getModules().size() == 1,
+			"Module text does not contain one module");
+
+	return ir;
+}
+
+// Appends the next chunk of the file to text, false on errors
+static bool readChunk(CompressedFile &file, std::string &text, bool &end) {
+	const size_t chunk = 1 << 20;
+	size_t size = text.size();
+
+	text.resize(size + chunk);
+	try {
+		size_t n = file.read(&text[size], chunk);
+		text.resize(size + n);
+		end = (n == 0);
+	} catch (std::runtime_error &e) {
+		std::cerr << "Decompression error: " << e.what() << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool Firrtlator::impl::parseCompressed(CompressedFile &file,
+		std::string type) {
+	bool end = false;
+
+	// The cache, incremental parsing and images need the whole content
+	if (mCache || mIncremental || (type == "FIRB")) {
+		auto content = std::make_shared<std::string>();
+		while (!end) {
+			if (!readChunk(file, *content, end))
+				return false;
+		}
+		return parse(content->data(), content->size(), type, content);
+	}
+
+	auto ir = parseStream(file, type, mThreads);
+	if (!ir)
+		return false;
+
+	mIR = ir;
+	mModuleHashes.clear();
+	mParsed.clear();
+	for (const auto &m : mIR->getModules())
+		mParsed.push_back(m->getId());
+
+	return true;
+}
+
+std::shared_ptr<Circuit> Firrtlator::impl::parseStream(CompressedFile &file,
+		std::string type, unsigned threads) {
+	auto arena = Arena::create();
+	std::shared_ptr<Circuit> ir;
+	bool end = false;
+
+	auto append = [&] (const std::string &header, const char *begin,
+			const char *last) {
+		auto c = parseModule(header, begin, last, type, arena, threads);
+		if (!c)
+			return false;
+		if (ir)
+			ir->addModule(c->getModules()[0]);
+		else
+			ir = c;
+		return true;
+	};
+
+	// Holds the circuit header until the first module starts, then the
+	// text from the start of the current module on. A module is parsed
+	// when the next one starts, so only one module is held in memory.
+	std::string text;
+	std::string header;
+	bool inModule = false;
+	// Lines before this offset are known to not start another module
+	size_t scanned = 0;
+
+	while (!end) {
+		if (!readChunk(file, text, end))
+			return nullptr;
+
+		if (end && !text.empty() && (text.back() != '\n'))
+			text.push_back('\n');
+
+		// Only complete lines are scanned
+		size_t complete = text.rfind('\n');
+		if ((complete == std::string::npos) || (complete + 1 <= scanned))
+			continue;
+		complete++;
+
+		const char *base = text.data();
+		std::vector<const char*> modules = Frontend::Scanner::findModules(
+				base + scanned, base + complete);
+		scanned = complete;
+
+		size_t first = 0;
+		for (auto m : modules) {
+			if (!inModule) {
+				header.assign(base, m);
+				inModule = true;
+			} else if (!append(header, base + first, m)) {
+				return nullptr;
+			}
+			first = m - base;
+		}
+
+		text.erase(0, first);
+		scanned -= first;
+	}
+
+	if (inModule) {
+		if (!append(header, text.data(), text.data() + text.size()))
+			return nullptr;
+	} else {
+		// Without modules the circuit is parsed as a whole
+		ir = parseFrontend(text.data(), text.size(), type, nullptr, arena,
+				threads);
+	}
+
+	return ir;
+}
+
+std::shared_ptr<Circuit> Firrtlator::impl::parseFile(
+		const std::string &filename, std::string type, unsigned threads) {
+	auto compression = CompressedFile::getCompression(filename);
+	if (compression != CompressedFile::NONE) {
+		CompressedFile file(filename, compression);
+		if (!file.isOpen())
+			return nullptr;
+		return parseStream(file, type, threads);
+	}
+
+	auto file = std::make_shared<MappedFile>(filename);
+	if (!file->isOpen())
+		return nullptr;
+
+	return parseFrontend(file->begin(), file->size(), type, file,
+			Arena::create(), threads);
+}
+
+bool Firrtlator::impl::parseFiles(const std::vector<std::string> &filenames,
+		std::string type) {
+	std::vector<std::shared_ptr<Circuit> > circuits(filenames.size());
+	std::vector<std::exception_ptr> errors(filenames.size());
+	std::atomic<size_t> next(0);
+
+	// The threads not needed for the files go to the frontends
+	unsigned numThreads = std::min<size_t>(mThreads, filenames.size());
+	unsigned frontendThreads = mThreads / numThreads;
+
+	auto worker = [&] () {
+		for (size_t i = next++; i < filenames.size(); i = next++) {
+			try {
+				circuits[i] = parseFile(filenames[i], type, frontendThreads);
+			} catch (...) {
+				errors[i] = std::current_exception();
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned t = 1; t < numThreads; t++)
+		threads.push_back(std::thread(worker));
+	worker();
+	for (auto &t : threads)
+		t.join();
+
+	for (size_t i = 0; i < filenames.size(); i++) {
+		if (errors[i])
+			std::rethrow_exception(errors[i]);
+		if (!circuits[i]) {
+			std::cerr << "Failed parsing " << filenames[i] << std::endl;
+			return false;
+		}
+	}
+
+	// Modules shared by several inputs are kept once, if their definitions
+	// are identical. The hashes are only computed for such modules.
+	struct Definition {
+		size_t file;
+		std::shared_ptr<Module> module;
+		uint64_t hash;
+		bool hashed;
+	};
+
+	std::unordered_map<std::string, Definition> definitions;
+	std::vector<std::shared_ptr<Module> > modules;
+
+	for (size_t i = 0; i < circuits.size(); i++) {
+		for (const auto &m : circuits[i]->getModules()) {
+			auto it = definitions.find(m->getId());
+			if (it == definitions.end()) {
+				definitions.emplace(m->getId(), Definition { i, m, 0, false });
+				modules.push_back(m);
+				continue;
+			}
+
+			Definition &def = it->second;
+			if (!def.hashed) {
+				def.hash = Backend::Firb::Visitor::structuralHash(def.module);
+				def.hashed = true;
+			}
+
+			if (Backend::Firb::Visitor::structuralHash(m) != def.hash) {
+				std::cerr << "Conflicting definitions of module " << m->getId()
+						<< " in " << filenames[def.file] << " and "
+						<< filenames[i] << std::endl;
+				return false;
+			}
+		}
+	}
+
+	// The first input defines the circuit
+	mIR = circuits[0];
+	mIR->setModules(modules);
+
+	mModuleHashes.clear();
+	mParsed.clear();
+	for (auto m : modules)
+		mParsed.push_back(m->getId());
+
+	return true;
+}
+
+bool Firrtlator::impl::parseCached(const char *buffer, size_t size,
+		std::string type, std::shared_ptr<const void> owner) {
+	std::shared_ptr<Circuit> ir;
+
+	// Images are loaded faster than from the cache
+	if (!mCache || (type == "FIRB")) {
+		ir = parseFrontend(buffer, size, type, owner, Arena::create(),
+				mThreads);
+		if (!ir)
+			return false;
+		mIR = ir;
+		return true;
+	}
+
+	ParseCache::Key key = mCache->key(buffer, size, type);
+
+	const char *image;
+	size_t imageSize;
+	auto entry = mCache->lookup(key, image, imageSize);
+	if (entry) {
+		// The entry stays mapped as long as the module bodies are loaded
+		// from it
+		ir = parseFrontend(image, imageSize, "FIRB", entry, Arena::create(),
+				mThreads);
+		if (ir) {
+			mIR = ir;
+			mCache->hit();
+			return true;
+		}
+		mCache->invalidate(key);
+	}
+
+	mCache->miss();
+
+	ir = parseFrontend(buffer, size, type, owner, Arena::create(), mThreads);
+	if (!ir)
+		return false;
+
+	// Storing parses the lazily loaded module bodies, an error in one of
+	// them fails the parse like it would later without the cache
+	try {
+		mCache->store(key, ir);
+	} catch (std::runtime_error &e) {
+		std::cerr << e.what() << std::endl;
+		return false;
+	}
+	mIR = ir;
+
+	return true;
+}
+
+std::shared_ptr<Circuit> Firrtlator::impl::parseFrontend(const char *buffer,
+		size_t size, std::string type, std::shared_ptr<const void> owner,
+		std::shared_ptr<Arena> arena, unsigned threads) {
+	std::shared_ptr<Frontend::FrontendBase> frontend;
+	frontend = Frontend::Registry::create(type);
+	frontend->setThreads(threads);
+	frontend->setInputOwner(owner);
+
+	// All nodes of the circuit are allocated from its arena
+	ArenaScope scope(arena);
+
+	if (!frontend->parseString(buffer, buffer + size))
+		return nullptr;
+	auto ir = frontend->getIR();
+	ir->setArena(arena);
+
+	return ir;
+}
+
 Firrtlator::Firrtlator() : pimpl(new impl()) {}
 
 Firrtlator::~Firrtlator() {}
@@ -44,6 +531,9 @@ std::vector<Firrtlator::FrontendDescriptor> Firrtlator::getFrontends() {
 std::string Firrtlator::getFrontend(std::string type) {
 	auto desc = Frontend::Registry::getDescriptors();
 
+	// Compressed files are read by the frontend of their content
+	type = CompressedFile::stripExtension(type);
+
 	for (auto f : desc) {
 		if (std::find(f.filetypes.begin(), f.filetypes.end(), type)
 			!= f.filetypes.end()) {
@@ -54,38 +544,118 @@ std::string Firrtlator::getFrontend(std::string type) {
 	throw std::runtime_error("Cannot find backend for: " + type);
 }
 
+void Firrtlator::setThreads(unsigned threads) {
+	pimpl->mThreads = (threads > 0) ? threads : 1;
+}
+
+void Firrtlator::setCache(std::string directory, uint64_t limit) {
+	pimpl->mCache.reset(new ParseCache(directory, limit));
+}
+
+Firrtlator::CacheStatistics Firrtlator::getCacheStatistics() {
+	CacheStatistics stats = {};
+
+	if (pimpl->mCache) {
+		ParseCache::Statistics s = pimpl->mCache->getStatistics();
+		stats.hits = s.hits;
+		stats.misses = s.misses;
+		stats.stores = s.stores;
+		stats.evictions = s.evictions;
+		stats.entries = s.entries;
+		stats.bytes = s.bytes;
+	}
+
+	return stats;
+}
+
+void Firrtlator::setIncremental(bool incremental) {
+	pimpl->mIncremental = incremental;
+	pimpl->mModuleHashes.clear();
+}
+
+std::vector<std::string> Firrtlator::getParsedModules() {
+	return pimpl->mParsed;
+}
+
 bool Firrtlator::parse(std::string::const_iterator begin,
 		std::string::const_iterator end, std::string type) {
+	if (begin == end)
+		return parseBuffer(nullptr, 0, type);
 
-	std::shared_ptr<Frontend::FrontendBase> frontend;
-	frontend = Frontend::Registry::create(type);
-
-	if (!frontend->parseString(begin, end))
-		return false;
-	pimpl->mIR = frontend->getIR();
+	return parseBuffer(&*begin, end - begin, type);
+}
 
-	return true;
+bool Firrtlator::parseBuffer(const char *buffer, size_t size,
+		std::string type) {
+	return pimpl->parse(buffer, size, type, nullptr);
 }
 
 bool Firrtlator::parseFile(std::string filename, std::string type) {
-    std::ifstream in(filename, std::ios_base::in);
-    if (!in) {
-        // TODO: log
-        return false;
-    }
-    std::string str((std::istreambuf_iterator<char>(in)),
-                     std::istreambuf_iterator<char>());
+	auto compression = CompressedFile::getCompression(filename);
+	if (compression != CompressedFile::NONE) {
+		CompressedFile file(filename, compression);
+		if (!file.isOpen()) {
+			// TODO: log
+			return false;
+		}
 
-    return parse(str.begin(), str.end(), type);
+		return pimpl->parseCompressed(file, type);
+	}
+
+	auto file = std::make_shared<MappedFile>(filename);
+	if (!file->isOpen()) {
+		// TODO: log
+		return false;
+	}
+
+	// The file stays mapped as long as the frontend references it
+	return pimpl->parse(file->begin(), file->size(), type, file);
 }
 
-bool Firrtlator::parseString(std::string content, std::string type) {
-	return parse(content.begin(), content.end(), type);
+bool Firrtlator::parseFiles(std::vector<std::string> filenames,
+		std::string type) {
+	throwAssert(!filenames.empty(), "No input files");
+
+	if (filenames.size() == 1)
+		return parseFile(filenames[0], type);
 
+	return pimpl->parseFiles(filenames, type);
+}
+
+bool Firrtlator::parseString(const std::string &content, std::string type) {
+	return parseBuffer(content.data(), content.size(), type);
 }
 
 void Firrtlator::elaborate() {
-	// Nothing for now
+	pass("resolve");
+}
+
+static Firrtlator::HierarchyCounts counts(const Hierarchy::Statistics &s) {
+	Firrtlator::HierarchyCounts c;
+	c.registers = s.registers;
+	c.regBits = s.regBits;
+	c.memories = s.memories;
+	c.memoryBits = s.memoryBits;
+	c.nodes = s.nodes;
+	c.instances = s.instances;
+	return c;
+}
+
+std::vector<Firrtlator::ModuleStatistics>
+Firrtlator::getHierarchyStatistics() {
+	std::vector<ModuleStatistics> list;
+	Hierarchy hierarchy(pimpl->mIR);
+
+	for (auto m : hierarchy.getOrder()) {
+		ModuleStatistics stats;
+		stats.name = m->getId();
+		stats.count = hierarchy.getInstanceCount(m);
+		stats.local = counts(hierarchy.getLocal(m));
+		stats.total = counts(hierarchy.getTotal(m));
+		list.push_back(stats);
+	}
+
+	return list;
 }
 
 std::vector<Firrtlator::PassDescriptor> Firrtlator::getPasses() {
@@ -95,14 +665,19 @@ std::vector<Firrtlator::PassDescriptor> Firrtlator::getPasses() {
 
 void Firrtlator::pass(std::string id) {
 	std::shared_ptr<Pass::PassBase> p = Pass::Registry::create(id);
+	p->setThreads(pimpl->mThreads);
+	ArenaScope scope(pimpl->mIR->getArena());
 	p->run(pimpl->mIR);
+
+	if (id == Pass::Resolve::Pass::name)
+		pimpl->mResolved = pimpl->mIR;
 }
 
 void Firrtlator::generate(std::string filename, std::string type) {
 	std::shared_ptr<Backend::BackendBase> backend;
 
 	std::fstream fs;
-    fs.open (filename, std::fstream::out);
+    fs.open (filename, std::fstream::out | std::fstream::binary);
 
 	backend = Backend::Registry::create(type, fs);
 	backend->generate(pimpl->mIR);
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Hash.h"
+
+#include <cstring>
+
+namespace Firrtlator {
+
+static const uint64_t prime1 = 0x9E3779B185EBCA87ull;
+static const uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+static const uint64_t prime3 = 0x165667B19E3779F9ull;
+static const uint64_t prime4 = 0x85EBCA77C2B2AE63ull;
+static const uint64_t prime5 = 0x27D4EB2F165667C5ull;
+
+static inline uint64_t rotl(uint64_t x, int r) {
+	return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read64(const char *p) {
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint32_t read32(const char *p) {
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint64_t mix(uint64_t acc, uint64_t input) {
+	acc += input * prime2;
+	acc = rotl(acc, 31);
+	return acc * prime1;
+}
+
+static inline uint64_t merge(uint64_t acc, uint64_t val) {
+	acc ^= mix(0, val);
+	return acc * prime1 + prime4;
+}
+
+uint64_t hash64(const char *buffer, size_t size, uint64_t seed) {
+	const char *p = buffer;
+	const char *end = buffer + size;
+	uint64_t h;
+
+	if (size >= 32) {
+		uint64_t v1 = seed + prime1 + prime2;
+		uint64_t v2 = seed + prime2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - prime1;
+
+		for (; p + 32 <= end; p += 32) {
+			v1 = mix(v1, read64(p));
+			v2 = mix(v2, read64(p + 8));
+			v3 = mix(v3, read64(p + 16));
+			v4 = mix(v4, read64(p + 24));
+		}
+
+		h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+		h = merge(h, v1);
+		h = merge(h, v2);
+		h = merge(h, v3);
+		h = merge(h, v4);
+	} else {
+		h = seed + prime5;
+	}
+
+	h += size;
+
+	for (; p + 8 <= end; p += 8) {
+		h ^= mix(0, read64(p));
+		h = rotl(h, 27) * prime1 + prime4;
+	}
+
+	if (p + 4 <= end) {
+		h ^= read32(p) * prime1;
+		h = rotl(h, 23) * prime2 + prime3;
+		p += 4;
+	}
+
+	for (; p < end; p++) {
+		h ^= (uint8_t) *p * prime5;
+		h = rotl(h, 11) * prime1;
+	}
+
+	h ^= h >> 33;
+	h *= prime2;
+	h ^= h >> 29;
+	h *= prime3;
+	h ^= h >> 32;
+
+	return h;
+}
+
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "MappedFile.h"
+
+#include <fstream>
+#include <iterator>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Firrtlator {
+
+MappedFile::MappedFile(std::string filename)
+: mMapping(nullptr), mSize(0), mOpen(false) {
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return;
+
+	struct stat st;
+	if ((fstat(fd, &st) == 0) && S_ISREG(st.st_mode)) {
+		mSize = st.st_size;
+		mOpen = true;
+
+		if (mSize > 0) {
+			void *map = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (map != MAP_FAILED) {
+				// The lexer walks the file strictly front to back
+				madvise(map, mSize, MADV_SEQUENTIAL);
+				mMapping = map;
+			}
+		}
+	}
+
+	close(fd);
+
+	if (mMapping || (mOpen && mSize == 0))
+		return;
+
+	// Fall back to reading the content if mapping is not possible
+	std::ifstream in(filename, std::ios_base::in | std::ios_base::binary);
+	if (!in) {
+		mOpen = false;
+		return;
+	}
+
+	mBuffer.assign(std::istreambuf_iterator<char>(in),
+			std::istreambuf_iterator<char>());
+	mSize = mBuffer.size();
+	mOpen = true;
+}
+
+MappedFile::~MappedFile() {
+	if (mMapping)
+		munmap(mMapping, mSize);
+}
+
+bool MappedFile::isOpen() {
+	return mOpen;
+}
+
+const char *MappedFile::begin() {
+	if (mMapping)
+		return static_cast<const char*>(mMapping);
+	return mBuffer.data();
+}
+
+const char *MappedFile::end() {
+	return begin() + mSize;
+}
+
+size_t MappedFile::size() {
+	return mSize;
+}
+
+}
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2016 Stefan Wallentowitz <wallento@silicon-semantics.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ParseCache.h"
+#include "FirbFormat.h"
+#include "Hash.h"
+#include "FirrtlatorBackend.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace Firrtlator {
+
+static const char magic[4] = { 'F', 'I', 'R', 'C' };
+static const char *suffix = ".firc";
+static const char *tmpPrefix = ".tmp-";
+// Temporary files of processes that died while writing are removed
+static const time_t tmpTimeout = 3600;
+
+ParseCache::ParseCache(std::string directory, uint64_t limit)
+: mDirectory(directory), mLimit(limit), mStatistics() {
+	// Create the directory and its parents, failures show up as misses
+	for (size_t pos = 1; pos != std::string::npos; pos++) {
+		pos = mDirectory.find('/', pos);
+		mkdir(mDirectory.substr(0, pos).c_str(), 0777);
+		if (pos == std::string::npos)
+			break;
+	}
+}
+
+ParseCache::Key ParseCache::key(const char *buffer, size_t size,
+		std::string frontend) {
+	// Images of other versions may not be compatible
+	std::string version = std::string(PACKAGE_VERSION) + "/" + frontend;
+
+	Key result;
+	result.hash = hash64(buffer, size, hash64(version.data(), version.size()));
+	result.size = size;
+	result.frontend = frontend;
+	return result;
+}
+
+std::string ParseCache::path(const Key &key) {
+	char name[17];
+	snprintf(name, sizeof(name), "%016llx", (unsigned long long) key.hash);
+	return mDirectory + "/" + name + "-" + key.frontend + suffix;
+}
+
+std::shared_ptr<MappedFile> ParseCache::lookup(const Key &key,
+		const char *&image, size_t &size) {
+	std::string filename = path(key);
+	auto file = std::make_shared<MappedFile>(filename);
+	if (!file->isOpen() || file->size() < sizeof(Header))
+		return nullptr;
+
+	Header header;
+	memcpy(&header, file->begin(), sizeof(header));
+	if ((memcmp(header.magic, magic, sizeof(magic)) != 0) ||
+			(header.version != Firb::version) ||
+			(header.hash != key.hash) || (header.size != key.size))
+		return nullptr;
+
+	// Mark as recently used, a read-only cache is fine as well
+	utimes(filename.c_str(), nullptr);
+
+	image = file->begin() + sizeof(Header);
+	size = file->size() - sizeof(Header);
+	return file;
+}
+
+bool ParseCache::store(const Key &key, std::shared_ptr<Circuit> ir) {
+	std::string filename = path(key);
+
+	char host[64] = "";
+	gethostname(host, sizeof(host) - 1);
+	std::string tmp = mDirectory + "/" + tmpPrefix + host + "-" +
+			std::to_string(getpid()) + "-" +
+			filename.substr(mDirectory.size() + 1);
+
+	Header header;
+	memcpy(header.magic, magic, sizeof(magic));
+	header.version = Firb::version;
+	header.hash = key.hash;
+	header.size = key.size;
+
+	std::ofstream os(tmp, std::ios_base::out | std::ios_base::binary |
+			std::ios_base::trunc);
+	if (!os)
+		return false;
+
+	os.write((const char*) &header, sizeof(header));
+	try {
+		// Writes lazily parsed module bodies, which may fail to parse
+		Backend::Registry::create("FIRB", os)->generate(ir);
+	} catch (std::runtime_error &e) {
+		os.close();
+		unlink(tmp.c_str());
+		throw;
+	}
+	os.close();
+
+	// Readers either see the old entry or the complete new one
+	if (!os || (rename(tmp.c_str(), filename.c_str()) != 0)) {
+		unlink(tmp.c_str());
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	mStatistics.stores++;
+	scan(true);
+
+	return true;
+}
+
+void ParseCache::invalidate(const Key &key) {
+	unlink(path(key).c_str());
+}
+
+void ParseCache::hit() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	mStatistics.hits++;
+}
+
+void ParseCache::miss() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	mStatistics.misses++;
+}
+
+ParseCache::Statistics ParseCache::getStatistics() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	scan(false);
+	return mStatistics;
+}
+
+void ParseCache::scan(bool evict) {
+	struct Entry {
+		std::string path;
+		uint64_t size;
+		time_t used;
+	};
+
+	std::vector<Entry> entries;
+	uint64_t bytes = 0;
+	time_t now = time(nullptr);
+
+	DIR *dir = opendir(mDirectory.c_str());
+	if (!dir)
+		return;
+
+	while (struct dirent *d = readdir(dir)) {
+		std::string name = d->d_name;
+		std::string filename = mDirectory + "/" + name;
+		struct stat st;
+
+		if (stat(filename.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+			continue;
+
+		if (name.compare(0, strlen(tmpPrefix), tmpPrefix) == 0) {
+			if (evict && (now - st.st_mtime > tmpTimeout))
+				unlink(filename.c_str());
+			continue;
+		}
+
+		if ((name.size() <= strlen(suffix)) ||
+				(name.compare(name.size() - strlen(suffix),
+						strlen(suffix), suffix) != 0))
+			continue;
+
+		entries.push_back({ filename, (uint64_t) st.st_size, st.st_mtime });
+		bytes += st.st_size;
+	}
+
+	closedir(dir);
+
+	if (evict && (mLimit > 0) && (bytes > mLimit)) {
+		std::sort(entries.begin(), entries.end(),
+				[](const Entry &a, const Entry &b) {
+			return a.used < b.used;
+		});
+
+		// Others may evict concurrently, a missing file is fine
+		size_t evicted = 0;
+		for (; (evicted < entries.size()) && (bytes > mLimit); evicted++) {
+			if (unlink(entries[evicted].path.c_str()) == 0)
+				mStatistics.evictions++;
+			bytes -= entries[evicted].size;
+		}
+		entries.erase(entries.begin(), entries.begin() + evicted);
+	}
+
+	mStatistics.entries = entries.size();
+	mStatistics.bytes = bytes;
+}
+
+}
@@ -21,11 +21,109 @@
  */
 
 #include "Visitor.h"
+#include "StaticVisitor.h"
 
 namespace Firrtlator {
 
 Visitor::~Visitor() {
 
 }
- 
+
+RefVisitor::~RefVisitor() {
+
+}
+
+namespace {
+
+// Node handed to the handlers of the visitor
+template <typename T>
+T &wrap(T &n, RefVisitor &) {
+	return n;
+}
+
+template <typename T>
+std::shared_ptr<T> wrap(T &n, Visitor &) {
+	return std::static_pointer_cast<T>(n.shared_from_this());
+}
+
+#define WALK_NODE(T) \
+	bool visit##T(T &n) { return mVisitor->visit(wrap(n, *mVisitor)); } \
+	void leave##T(T &n) { mVisitor->leave(wrap(n, *mVisitor)); }
+
+#define WALK_LEAF(T) \
+	void visit##T(T &n) { mVisitor->visit(wrap(n, *mVisitor)); }
+
+#define WALK_DECLARATION(T) \
+	bool visit##T(T &n) { return mVisitor->visit(wrap(n, *mVisitor)); }
+
+// Forwards the walk of the StaticVisitor to the virtual handlers
+template <typename V>
+class Walker : public StaticVisitor<Walker<V> > {
+public:
+	Walker() : mVisitor(nullptr) {}
+
+	void walk(IRNode &root, V &v) {
+		V *outer = mVisitor;
+		mVisitor = &v;
+		try {
+			this->traverse(root);
+		} catch (...) {
+			mVisitor = outer;
+			throw;
+		}
+		mVisitor = outer;
+	}
+
+	WALK_NODE(Circuit)
+	WALK_NODE(Module)
+	WALK_NODE(Port)
+	WALK_DECLARATION(Parameter)
+	WALK_LEAF(TypeInt)
+	WALK_LEAF(TypeClock)
+	WALK_NODE(Field)
+	WALK_NODE(TypeBundle)
+	WALK_NODE(TypeVector)
+	WALK_NODE(StmtGroup)
+	WALK_NODE(Wire)
+	WALK_NODE(Reg)
+	WALK_NODE(Instance)
+	WALK_DECLARATION(Memory)
+	WALK_NODE(Node)
+	WALK_NODE(Connect)
+	WALK_NODE(Invalid)
+	WALK_NODE(Conditional)
+	WALK_NODE(ConditionalElse)
+	WALK_NODE(Stop)
+	WALK_NODE(Printf)
+	WALK_LEAF(Empty)
+	WALK_LEAF(Reference)
+	WALK_LEAF(Constant)
+	WALK_NODE(SubField)
+	WALK_NODE(SubIndex)
+	WALK_NODE(SubAccess)
+	WALK_NODE(Mux)
+	WALK_NODE(CondValid)
+	WALK_NODE(PrimOp)
+private:
+	V *mVisitor;
+};
+
+// Handlers often walk a subtree themselves, so all walks of a thread
+// share one walker and the capacity of its stack
+template <typename V>
+Walker<V> &walker() {
+	static thread_local Walker<V> w;
+	return w;
+}
+
+}
+
+void walk(IRNode &root, Visitor &v) {
+	walker<Visitor>().walk(root, v);
+}
+
+void walk(IRNode &root, RefVisitor &v) {
+	walker<RefVisitor>().walk(root, v);
+}
+
 }